@@ -23,10 +23,12 @@
 #include <capture_splitter.h>
 #include <iostream>
 #include <iomanip>
+#include <chrono>
 
 #include "capture_video.h"
 
 CaptureThread::CaptureThread(int cam_id)
+  : slot_capture_stats("capture_stats")
 {
   camId=cam_id;
   affinity=0;
@@ -40,6 +42,18 @@ CaptureThread::CaptureThread(int cam_id)
   // timings should only be printed on demand for a short period of time by temporally activating this flag
   control->addChild( (VarType*) (c_print_timings = new VarBool("print timings",false)));
   control->addChild( (VarType*) (c_refresh= new VarTrigger("re-read params","Refresh")));
+  // let the frame buffer hold the driver buffer directly, if no conversion is needed.
+  // applies from the next start; capture modules which can not hold a lease per bin copy the frames
+  control->addChild( (VarType*) (c_zero_copy = new VarBool("zero-copy frames",true)));
+  // acquire+convert and stack processing run on separate threads, overlapping consecutive frames
+  control->addChild( (VarType*) (c_pipelined = new VarBool("pipelined processing",false)));
+  control->addChild( (VarType*) (c_pipeline_depth = new VarInt("pipeline depth",1,1,4)));
+  // number of frames processed concurrently in pipelined mode; the output stays in capture order
+  control->addChild( (VarType*) (c_replicas = new VarInt("frame-parallel replicas",1,1,8)));
+  // whether frames waiting for processing may be skipped in favor of newer ones (pipelined mode)
+  control->addChild( (VarType*) (c_frame_policy = new VarStringEnum("frame policy","process every frame")));
+  c_frame_policy->addItem("process every frame");
+  c_frame_policy->addItem("process latest frame only");
   control->addChild( (VarType*) (captureModule= new VarStringEnum("Capture Module",camId < 1 ? "Read from files" : "None")));
   captureModule->addFlags(VARTYPE_FLAG_NOLOAD_ENUM_CHILDREN);
   captureModule->addItem("None");
@@ -59,6 +73,7 @@ CaptureThread::CaptureThread(int cam_id)
   connect(captureModule,SIGNAL(hasChanged(VarType *)),this,SLOT(selectCaptureMethod()));
   stack = 0;
   counter=new FrameCounter();
+  arrival_counter=new FrameCounter();
   capture=nullptr;
   captureFiles = new CaptureFromFile(fromfile, camId);
   captureVideo = new CaptureVideo(video);
@@ -122,6 +137,8 @@ CaptureThread::CaptureThread(int cam_id)
 
   selectCaptureMethod();
   _kill =false;
+  capturing=false;
+  processing_running=false;
   rb=0;
 }
 
@@ -145,6 +162,7 @@ CaptureThread::~CaptureThread()
   delete captureFiles;
   delete captureGenerator;
   delete counter;
+  delete arrival_counter;
 
 #ifdef DC1394
   delete captureDC1394;
@@ -192,6 +210,7 @@ VisionStack * CaptureThread::getStack() const {
 }
 
 void CaptureThread::selectCaptureMethod() {
+  const std::lock_guard<std::mutex> lease_lock(lease_mutex);
   capture_mutex.lock();
   CaptureInterface * old_capture=capture;
   CaptureInterface * new_capture=nullptr;
@@ -243,24 +262,46 @@ void CaptureThread::selectCaptureMethod() {
   }
 #endif
 
-  if (old_capture!=nullptr && new_capture!=old_capture && old_capture->isCapturing()) {
-    capture_mutex.unlock();
-    stop();
-    capture_mutex.lock();
+  if (new_capture!=old_capture) {
+    //the leases are ended while their capture module is still selected
+    endLeases();
+    if (old_capture!=nullptr && old_capture->isCapturing()) stopLocked();
   }
   capture=new_capture;
   capture_mutex.unlock();
 }
 
 void CaptureThread::kill() {
- _kill=true;
-  while(isRunning()) {
-    usleep(100);
+  _kill=true;
+  wakeIdle();
+  wait();
+}
+
+bool CaptureThread::isCapturing() const {
+  return capturing;
+}
+
+void CaptureThread::waitWhileIdle() {
+  std::unique_lock<std::mutex> lock(idle_mutex);
+  //the timeout keeps the idle statistics and the pipeline settings up to date
+  idle_wakeup.wait_for(lock, std::chrono::milliseconds(100), [&] { return idle_interrupted; });
+  idle_interrupted=false;
+}
+
+void CaptureThread::wakeIdle() {
+  {
+    const std::lock_guard<std::mutex> lock(idle_mutex);
+    idle_interrupted=true;
   }
+  idle_wakeup.notify_all();
 }
 
 bool CaptureThread::init() {
+  const std::lock_guard<std::mutex> lease_lock(lease_mutex);
   capture_mutex.lock();
+  //every bin of the frame buffer may hold a leased frame
+  leasing = (capture != nullptr) && (rb != 0) && c_zero_copy->getBool() && capture->setLeaseCount(rb->size);
+  if (!leasing && capture != nullptr) capture->setLeaseCount(0);
   bool res = (capture != nullptr) && capture->startCapture();
   if (res==true) {
     c_start->addFlags( VARTYPE_FLAG_READONLY );
@@ -269,11 +310,20 @@ bool CaptureThread::init() {
     c_stop->removeFlags( VARTYPE_FLAG_READONLY );
   }
   capture_mutex.unlock();
+  if (res) wakeIdle();
   return res;
 }
 
 bool CaptureThread::stop() {
+  const std::lock_guard<std::mutex> lease_lock(lease_mutex);
   capture_mutex.lock();
+  bool res = stopLocked();
+  capture_mutex.unlock();
+  return res;
+}
+
+bool CaptureThread::stopLocked() {
+  endLeases();
   bool res = (capture != nullptr) && capture->stopCapture();
   if (res==true) {
     c_stop->addFlags( VARTYPE_FLAG_READONLY );
@@ -281,10 +331,23 @@ bool CaptureThread::stop() {
     c_start->removeFlags( VARTYPE_FLAG_READONLY );
     c_reset->removeFlags( VARTYPE_FLAG_READONLY );
   }
-  capture_mutex.unlock();
   return res;
 }
 
+void CaptureThread::endLeases() {
+  if (rb==0) return;
+  for (int i=0;i<rb->size;i++) {
+    RawImage & video=rb->getPointer(i)->video;
+    if (video.isLeased()) {
+      RawImage leased;
+      leased.lease(video);
+      //the last frames stay on display
+      video.detach();
+      if (capture != nullptr) capture->releaseLease(leased);
+    }
+  }
+}
+
 bool CaptureThread::reset() {
   capture_mutex.lock();
   bool res = (capture != nullptr) && capture->resetBus();
@@ -301,90 +364,301 @@ void CaptureThread::refresh() {
 }
 
 
-void CaptureThread::run() {
-    CaptureStats * stats;
-    bool changed;
+static void printTiming(const char * label, std::chrono::steady_clock::duration d, bool last=false) {
+  auto us = std::chrono::duration_cast<std::chrono::microseconds>(d);
+  std::cout << std::setw(13) << std::left << label
+            << std::setw(5) << std::right << us.count() << " μs" << std::endl;
+  if (last) std::cout << std::endl;
+}
+
+CaptureStats * CaptureThread::getCaptureStats(FrameData * d) {
+  return slot_capture_stats.getOrCreate(d->map);
+}
+
+void CaptureThread::updateCaptureStats(FrameData * d, CaptureStats * stats, bool & changed) {
+  bool arrival_changed;
+  counter->count();
+  stats->total=d->number=counter->getTotal();
+  stats->fps_capture=counter->getFPS(changed);
+  stats->fps_arrival=arrival_counter->getFPS(arrival_changed);
+  stats->dropped=handoff.getDropped();
+  stats->queue_age=GetTimeSec()-d->time;
+}
+
+void CaptureThread::processFrame(FrameData * d, CaptureStats * stats) {
+  bool changed;
+  updateCaptureStats(d, stats, changed);
+
+  stack_mutex.lock();
+  if (stack!=0) {
+    stack->process(d);
+    stack->postProcess(d);
+  }
+  stack_mutex.unlock();
+  rb->nextWrite(true);
+
+  if (changed) {
+    refreshAfterFpsUpdate();
+  }
+}
+
+void CaptureThread::refreshAfterFpsUpdate() {
+  if (c_auto_refresh->getBool()==true) {
+    capture_mutex.lock();
+    if ((capture != 0) && (capture->isCapturing())) capture->readAllParameterValues();
+    capture_mutex.unlock();
+  }
+  stack_mutex.lock();
+  if (stack!=0) stack->updateTimingStatistics();
+  stack_mutex.unlock();
+}
+
+bool CaptureThread::processReplica(FrameData * d, long long seq) {
+  bool changed;
+  CaptureStats * stats=getCaptureStats(d);
+
+  //frames are numbered in capture order
+  if (replica_sequencer.enter(0,seq)==false) return false;
+  updateCaptureStats(d, stats, changed);
+  replica_sequencer.leave(0,seq);
+
+  stack_mutex.lock();
+  VisionStack * s=stack;
+  stack_mutex.unlock();
+  if (s!=0 && s->processInSequence(d,seq)==false) return false;
+
+  //publish the finished replica to the frame buffer in capture order
+  if (replica_sequencer.enter(1,seq)==false) return false;
+  if (s!=0) s->postProcess(d);
+  rb->getPointer(rb->curWrite())->swap(*d);
+  rb->nextWrite(true);
+  replica_sequencer.leave(1,seq);
+
+  if (changed) {
+    refreshAfterFpsUpdate();
+  }
+  return true;
+}
+
+void CaptureThread::captureSerial() {
+  bool changed;
+  int idx=rb->curWrite();
+  FrameData * d=rb->getPointer(idx);
+  CaptureStats * stats=getCaptureStats(d);
+  std::unique_lock<std::mutex> lease_lock(lease_mutex);
+  capture_mutex.lock();
+  capturing=(capture != nullptr) && (capture->isCapturing());
+  if (capturing) {
+    //the frame leased into this bin is only handed back now that the bin is overwritten
+    if (d->video.isLeased()) {
+      capture->releaseLease(d->video);
+      d->video.clear();
+    }
+    auto t_start = std::chrono::steady_clock::now();
+    RawImage pic_raw=capture->getFrame();
+    auto t_getFrame = std::chrono::steady_clock::now();
+    pic_raw.setTime(GetTimeSec());
+    d->time = pic_raw.getTime();
+    d->time_cam=pic_raw.getTimeCam();
+    //a leased frame belongs to the bin, it stays valid for the GUI and later plugins until
+    //the bin is overwritten, so it is neither copied nor handed back by releaseFrame()
+    bool bSuccess = (leasing && c_zero_copy->getBool() && capture->leaseFrame( pic_raw,d->video))
+                    || capture->copyAndConvertFrame( pic_raw,d->video);
+    auto t_convert = std::chrono::steady_clock::now();
+    capture_mutex.unlock();
 
+    if (bSuccess) {           //only on a good frame read do we proceed
+      arrival_counter->count();
+      processFrame(d, stats);
+      auto t_process = std::chrono::steady_clock::now();
+
+      if(c_print_timings->getBool())
+      {
+        printTiming("getFrame", t_getFrame - t_start);
+        printTiming("copy&convert", t_convert - t_getFrame);
+        printTiming("process", t_process - t_convert);
+        printTiming("total", t_process - t_start, true);
+      }
+    }
+
+    capture_mutex.lock();
+    if ((capture != nullptr) && (capture->isCapturing())) {
+      capture->releaseFrame();
+    }
+    capture_mutex.unlock();
+  } else {
+    stats->total=d->number=counter->getTotal();
+    stats->fps_capture=counter->getFPS(changed);
+    //we are not capturing...wait until capture is started
+    capture_mutex.unlock();
+    lease_lock.unlock();
+    waitWhileIdle();
+  }
+}
+
+void CaptureThread::capturePipelined() {
+  handoff.setCapacity(c_pipeline_depth->getInt());
+  handoff.setLatestOnly(c_frame_policy->getString()=="process latest frame only");
+  RawImage staged=handoff.acquire();
+  capture_mutex.lock();
+  capturing=(capture != nullptr) && (capture->isCapturing());
+  if (capturing) {
+    auto t_start = std::chrono::steady_clock::now();
+    RawImage pic_raw=capture->getFrame();
+    auto t_getFrame = std::chrono::steady_clock::now();
+    pic_raw.setTime(GetTimeSec());
+    //frames are never leased here, as the driver buffer is released before processing
+    bool bSuccess = capture->copyAndConvertFrame( pic_raw,staged);
+    staged.setTime(pic_raw.getTime());
+    staged.setTimeCam(pic_raw.getTimeCam());
+    auto t_convert = std::chrono::steady_clock::now();
+    //the frame was copied into the staging buffer, so the driver can have it back right away
+    if (capture->isCapturing()) {
+      capture->releaseFrame();
+    }
+    capture_mutex.unlock();
+
+    if(c_print_timings->getBool())
+    {
+      printTiming("getFrame", t_getFrame - t_start);
+      printTiming("copy&convert", t_convert - t_getFrame, true);
+    }
+
+    if (bSuccess) {
+      arrival_counter->count();
+      handoff.push(staged);
+    } else {
+      handoff.recycle(staged);
+    }
+  } else {
+    //we are not capturing...wait until capture is started.
+    //the processing stage is woken as well, to keep its statistics up to date
+    capture_mutex.unlock();
+    handoff.recycle(staged);
+    handoff.notifyIdle();
+    waitWhileIdle();
+  }
+}
+
+void CaptureThread::runProcessingStage() {
+  bool changed;
+  if (affinity!=0) affinity->demandWorkerCores(camId);
+  while (processing_running) {
+    RawImage staged;
+    long long seq;
+    int idx=rb->curWrite();
+    FrameData * d=rb->getPointer(idx);
+    CaptureStats * stats=getCaptureStats(d);
+    if (handoff.pop(staged, seq)) {
+      auto t_start = std::chrono::steady_clock::now();
+      //swap the converted frame into the write bin; the previous buffer is reused by the capture stage
+      RawImage previous=d->video;
+      d->video=staged;
+      handoff.recycle(previous);
+      d->time = d->video.getTime();
+      d->time_cam = d->video.getTimeCam();
+      processFrame(d, stats);
+      if(c_print_timings->getBool())
+      {
+        printTiming("process", std::chrono::steady_clock::now() - t_start, true);
+      }
+    } else {
+      stats->total=d->number=counter->getTotal();
+      stats->fps_capture=counter->getFPS(changed);
+    }
+  }
+}
+
+void CaptureThread::runProcessingReplica(FrameData * d) {
+  if (affinity!=0) affinity->demandWorkerCores(camId);
+  while (processing_running) {
+    RawImage staged;
+    long long seq;
+    if (handoff.pop(staged, seq)) {
+      auto t_start = std::chrono::steady_clock::now();
+      //the replica's previous image went to the frame buffer bin it was swapped with,
+      //so what we get back here is no longer visible to any reader
+      RawImage previous=d->video;
+      d->video=staged;
+      handoff.recycle(previous);
+      d->time = d->video.getTime();
+      d->time_cam = d->video.getTimeCam();
+      if (processReplica(d, seq)==false) return;
+      if(c_print_timings->getBool())
+      {
+        printTiming("process", std::chrono::steady_clock::now() - t_start, true);
+      }
+    }
+  }
+}
+
+void CaptureThread::startProcessingStage() {
+  int n=c_replicas->getInt();
+  if (processing_running) {
+    if (n==(int)processing_threads.size()) return;
+    stopProcessingStage();
+  }
+  processing_running=true;
+  handoff.start();
+  if (n <= 1) {
+    processing_threads.emplace_back(&CaptureThread::runProcessingStage, this);
+    return;
+  }
+  stack_mutex.lock();
+  if (stack!=0) stack->resetSequence(0);
+  stack_mutex.unlock();
+  replica_sequencer.reset(2,0);
+  for (int i=0;i<n;i++) {
+    replicas.push_back(new FrameData());
+    processing_threads.emplace_back(&CaptureThread::runProcessingReplica, this, replicas.back());
+  }
+}
+
+void CaptureThread::stopProcessingStage() {
+  if (!processing_running) return;
+  processing_running=false;
+  handoff.stop();
+  stack_mutex.lock();
+  if (stack!=0) stack->abortSequence();
+  stack_mutex.unlock();
+  replica_sequencer.abort();
+  for (auto & t : processing_threads) {
+    if (t.joinable()) t.join();
+  }
+  processing_threads.clear();
+  for (auto d : replicas) {
+    handoff.recycle(d->video);
+    delete d;
+  }
+  replicas.clear();
+}
+
+void CaptureThread::run() {
     if (affinity!=0) {
-      affinity->demandCore(camId);
+      affinity->demandCaptureCore(camId);
     }
 
     while(true) {
       if (rb!=0) {
-        int idx=rb->curWrite();
-        FrameData * d=rb->getPointer(idx);
-        if ((stats=(CaptureStats *)d->map.get("capture_stats")) == 0) {
-          stats=(CaptureStats *)d->map.insert("capture_stats",new CaptureStats());
-        }
-        capture_mutex.lock();
-        if ((capture != nullptr) && (capture->isCapturing())) {
-          auto t_start = std::chrono::steady_clock::now();
-          RawImage pic_raw=capture->getFrame();
-          auto t_getFrame = std::chrono::steady_clock::now();
-          pic_raw.setTime(GetTimeSec());
-          d->time = pic_raw.getTime();
-          d->time_cam=pic_raw.getTimeCam();
-          bool bSuccess = capture->copyAndConvertFrame( pic_raw,d->video);
-          auto t_convert = std::chrono::steady_clock::now();
-          capture_mutex.unlock();
-
-          if (bSuccess) {           //only on a good frame read do we proceed
-              counter->count();
-              stats->total=d->number=counter->getTotal();
-              stats->fps_capture=counter->getFPS(changed);
-
-              stack_mutex.lock();
-              if (stack!=0) {
-                stack->process(d);
-                stack->postProcess(d);
-              }
-              stack_mutex.unlock();
-              rb->nextWrite(true);
-
-            auto t_process = std::chrono::steady_clock::now();
-
-              if(c_print_timings->getBool())
-              {
-                auto getFrame_duration = std::chrono::duration_cast<std::chrono::microseconds>(t_getFrame - t_start);
-                std::cout << std::setw(13) << std::left << "getFrame"
-                          << std::setw(5) << std::right << getFrame_duration.count() << " μs" << std::endl;
-                auto convert_duration = std::chrono::duration_cast<std::chrono::microseconds>(t_convert - t_getFrame);
-                std::cout << std::setw(13) << std::left << "copy&convert"
-                          << std::setw(5) << std::right << convert_duration.count() << " μs" << std::endl;
-                auto process_duration = std::chrono::duration_cast<std::chrono::microseconds>(t_process - t_convert);
-                std::cout << std::setw(13) << std::left << "process"
-                          << std::setw(5) << std::right << process_duration.count() << " μs" << std::endl;
-                auto total_duration = std::chrono::duration_cast<std::chrono::microseconds>(t_process - t_start);
-                std::cout << std::setw(13) << std::left << "total"
-                          << std::setw(5) << std::right << total_duration.count() << " μs" << std::endl << std::endl;
-              }
-
-              if (changed) {
-                if (c_auto_refresh->getBool()==true) {
-                  capture_mutex.lock();
-                  if ((capture != 0) && (capture->isCapturing())) capture->readAllParameterValues();
-                  capture_mutex.unlock();
-                }
-                stack_mutex.lock();
-                stack->updateTimingStatistics();
-                stack_mutex.unlock();
-              }
-          }
-
-          capture_mutex.lock();
-          if ((capture != nullptr) && (capture->isCapturing())) {
-            capture->releaseFrame();
+        if (c_pipelined->getBool()) {
+          {
+            //the replicas are swapped into the bins, which must not hold leases then
+            const std::lock_guard<std::mutex> lease_lock(lease_mutex);
+            capture_mutex.lock();
+            endLeases();
+            capture_mutex.unlock();
           }
-          capture_mutex.unlock();
+          startProcessingStage();
+          capturePipelined();
         } else {
-          stats->total=d->number=counter->getTotal();
-          stats->fps_capture=counter->getFPS(changed);
-          //we are not capturing...chill this thread out...
-          capture_mutex.unlock();
-          usleep(5000);
+          stopProcessingStage();
+          captureSerial();
         }
         if (_kill) {
+          stopProcessingStage();
+          const std::lock_guard<std::mutex> lease_lock(lease_mutex);
           capture_mutex.lock();
+          endLeases();
           if(capture != nullptr) {
             capture->stopCapture();
             //make sure to read latest params from camera to be saved to file...
@@ -396,3 +670,112 @@ void CaptureThread::run() {
       }
     }
 }
+
+CaptureHandoff::~CaptureHandoff() {
+  for (auto & img : queue) {
+    img.clear();
+  }
+  for (auto & img : pool) {
+    img.clear();
+  }
+}
+
+RawImage CaptureHandoff::acquire() {
+  const std::lock_guard<std::mutex> lock(queue_mutex);
+  if (pool.empty()) return RawImage();
+  RawImage img=pool.back();
+  pool.pop_back();
+  return img;
+}
+
+void CaptureHandoff::recycle(const RawImage & img) {
+  const std::lock_guard<std::mutex> lock(queue_mutex);
+  pool.push_back(img);
+}
+
+bool CaptureHandoff::push(const RawImage & img) {
+  std::unique_lock<std::mutex> lock(queue_mutex);
+  if (latest_only) {
+    //never hold back the capture stage, a newer frame replaces the oldest waiting one
+    while (running && queue.size() >= capacity) {
+      pool.push_back(queue.front());
+      queue.pop_front();
+      dropped++;
+    }
+  }
+  not_full.wait(lock, [&] {
+    return queue.size() < capacity || !running;
+  });
+  if (!running) {
+    pool.push_back(img);
+    return false;
+  }
+  queue.push_back(img);
+  not_empty.notify_one();
+  return true;
+}
+
+bool CaptureHandoff::pop(RawImage & img, long long & seq) {
+  std::unique_lock<std::mutex> lock(queue_mutex);
+  not_empty.wait(lock, [&] {
+    return !queue.empty() || !running || idle_pending;
+  });
+  if (!running) return false;
+  if (queue.empty()) {
+    idle_pending=false;
+    return false;
+  }
+  if (latest_only) {
+    while (queue.size() > 1) {
+      pool.push_back(queue.front());
+      queue.pop_front();
+      dropped++;
+    }
+  }
+  img=queue.front();
+  queue.pop_front();
+  seq=next_seq++;
+  not_full.notify_one();
+  return true;
+}
+
+void CaptureHandoff::notifyIdle() {
+  const std::lock_guard<std::mutex> lock(queue_mutex);
+  idle_pending=true;
+  not_empty.notify_one();
+}
+
+void CaptureHandoff::setCapacity(unsigned int _capacity) {
+  const std::lock_guard<std::mutex> lock(queue_mutex);
+  capacity = _capacity < 1 ? 1 : _capacity;
+  not_full.notify_one();
+}
+
+void CaptureHandoff::setLatestOnly(bool _latest_only) {
+  const std::lock_guard<std::mutex> lock(queue_mutex);
+  latest_only = _latest_only;
+}
+
+long long CaptureHandoff::getDropped() {
+  const std::lock_guard<std::mutex> lock(queue_mutex);
+  return dropped;
+}
+
+void CaptureHandoff::start() {
+  const std::lock_guard<std::mutex> lock(queue_mutex);
+  running=true;
+  idle_pending=false;
+  next_seq=0;
+}
+
+void CaptureHandoff::stop() {
+  const std::lock_guard<std::mutex> lock(queue_mutex);
+  running=false;
+  //frames that were not processed yet are dropped
+  while (!queue.empty()) {
+    pool.push_back(queue.front());
+    queue.pop_front();
+  }
+  not_empty.notify_all();
+  not_full.notify_all();
+}
@@ -35,6 +35,13 @@
 #include "visionstack.h"
 #include "capturestats.h"
 #include "affinity_manager.h"
+#include "frame_sequencer.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <deque>
+#include <vector>
 
 #ifdef MVIMPACT2
 #include "capture_bluefox2.h"
@@ -56,6 +63,56 @@
 #include "capture_spinnaker.h"
 #endif
 
+/*!
+  \class   CaptureHandoff
+  \brief   A bounded queue passing converted frames from the capture stage to the processing stage
+
+  The queue owns the image buffers it hands out. Buffers that were consumed
+  are returned with recycle() so that steady-state operation does not allocate.
+*/
+class CaptureHandoff
+{
+protected:
+  std::deque<RawImage> queue;
+  std::vector<RawImage> pool;
+  std::mutex queue_mutex;
+  std::condition_variable not_empty;
+  std::condition_variable not_full;
+  unsigned int capacity = 1;
+  bool running = false;
+  bool latest_only = false;
+  bool idle_pending = false;
+  long long next_seq = 0;
+  long long dropped = 0;
+
+public:
+  ~CaptureHandoff();
+
+  /// returns an unused image buffer (possibly unallocated)
+  RawImage acquire();
+  /// gives a buffer back to the pool once its content is no longer needed
+  void recycle(const RawImage & img);
+
+  /// appends a converted frame, blocking while the queue is full.
+  /// In latest-only mode it never blocks, but drops the oldest queued frame instead.
+  /// returns false (and recycles the frame) if the hand-off was stopped
+  bool push(const RawImage & img);
+  /// takes the oldest converted frame, waiting until there is one.
+  /// In latest-only mode all but the newest queued frame are dropped.
+  /// \p seq is set to the consecutive number of the frame since start().
+  /// returns false without a frame if the hand-off was stopped or notifyIdle() was called
+  bool pop(RawImage & img, long long & seq);
+  /// wakes one waiting pop() while the capture stage has no frames to deliver
+  void notifyIdle();
+
+  void setCapacity(unsigned int _capacity);
+  void setLatestOnly(bool _latest_only);
+  /// returns the number of frames dropped so far
+  long long getDropped();
+  void start();
+  void stop();
+};
+
 /*!
   \class   CaptureThread
   \brief   A thread for capturing and processing video data
@@ -67,8 +124,13 @@ Q_OBJECT
 protected:
   QMutex stack_mutex; //this mutex protects multi-threaded operations on the stack
   QMutex capture_mutex; //this mutex protects multi-threaded operations on the capture control
+  //held (before capture_mutex) while the frame buffer bins hold leased frames which may be in use,
+  //i.e. while a frame is captured and processed, and while the leases are ended
+  std::mutex lease_mutex;
+  bool leasing = false; //whether the capture module accepted a lease for every bin (see init())
   VisionStack * stack;
   FrameCounter * counter;
+  FrameCounter * arrival_counter; //counts frames delivered by the capture device
   CaptureInterface * capture = nullptr;
   CaptureInterface * captureDC1394 = nullptr;
   CaptureInterface * captureV4L = nullptr;
@@ -83,7 +145,8 @@ protected:
   CaptureInterface * captureSplitter = nullptr;
   AffinityManager * affinity;
   FrameBuffer * rb;
-  bool _kill;
+  std::atomic<bool> _kill;
+  std::atomic<bool> capturing; //as seen by the last capture attempt
   int camId;
   VarList * settings;
   VarList * dc1394 = nullptr;
@@ -104,8 +167,49 @@ protected:
   VarTrigger * c_refresh;
   VarBool * c_auto_refresh;
   VarBool * c_print_timings;
+  VarBool * c_zero_copy;
+  VarBool * c_pipelined;
+  VarInt * c_pipeline_depth;
+  VarInt * c_replicas;
+  VarStringEnum * c_frame_policy;
   VarStringEnum * captureModule;
 
+  // pipelined mode: frames are acquired and converted on this thread and
+  // processed by the stack on processing_threads.
+  // with more than one replica, consecutive frames are processed concurrently,
+  // each processing thread working on its own FrameData replica. The finished
+  // replicas are swapped into the frame buffer in capture order.
+  CaptureHandoff handoff;
+  std::vector<std::thread> processing_threads;
+  std::vector<FrameData *> replicas;
+  std::atomic<bool> processing_running;
+  FrameSequencer replica_sequencer; //stage 0: frame numbering, stage 1: publishing
+
+  // while not capturing, the thread sleeps here until capture is started or the thread is killed
+  std::mutex idle_mutex;
+  std::condition_variable idle_wakeup;
+  bool idle_interrupted = false;
+  void waitWhileIdle();
+  void wakeIdle();
+
+  FrameDataSlot<CaptureStats> slot_capture_stats;
+
+  CaptureStats * getCaptureStats(FrameData * d);
+  void updateCaptureStats(FrameData * d, CaptureStats * stats, bool & changed);
+  void captureSerial();
+  void capturePipelined();
+  void processFrame(FrameData * d, CaptureStats * stats);
+  /// hands the leased frames of all bins back to the capture module, keeping
+  /// copies of them for display. Called with lease_mutex and capture_mutex held.
+  void endLeases();
+  bool stopLocked();
+  bool processReplica(FrameData * d, long long seq);
+  void refreshAfterFpsUpdate();
+  void startProcessingStage();
+  void stopProcessingStage();
+  void runProcessingStage();
+  void runProcessingReplica(FrameData * d);
+
 public slots:
   bool init();
   bool stop();
@@ -122,6 +226,9 @@ public:
   VarList * getSettings();
   void setAffinityManager(AffinityManager * _affinity);
   CaptureInterface* getCaptureSplitter() {return captureSplitter;};
+  /// whether the capture module was capturing at the last attempt to get a frame.
+  /// Unlike the capture module itself, this never blocks.
+  bool isCapturing() const;
   CaptureThread(int cam_id);
   ~CaptureThread();
 
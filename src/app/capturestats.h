@@ -29,11 +29,17 @@
 */
 class CaptureStats {
   public:
-  double fps_capture;
+  double fps_capture; //rate of processed frames
+  double fps_arrival; //rate of frames delivered by the capture device
   long long total;
+  long long dropped; //frames discarded by the frame policy, in total
+  double queue_age; //seconds between arrival and start of processing of the current frame
   CaptureStats() {
     fps_capture=0.0;
+    fps_arrival=0.0;
     total=0;
+    dropped=0;
+    queue_age=0.0;
   }
 };
 
@@ -0,0 +1,56 @@
+//========================================================================
+//  This software is free: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License Version 3,
+//  as published by the Free Software Foundation.
+//
+//  This software is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  Version 3 in the file COPYING that came with this distribution.
+//  If not, see <http://www.gnu.org/licenses/>.
+//========================================================================
+/*!
+  \file    detection_frame_slot.cpp
+  \brief   C++ Implementation: DetectionFrameArena, DetectionFrameSlot
+*/
+//========================================================================
+
+#include "detection_frame_slot.h"
+
+DetectionFrameArena::DetectionFrameArena() {
+  initial_block=new char[InitialBlockSize];
+  google::protobuf::ArenaOptions options;
+  options.initial_block=initial_block;
+  options.initial_block_size=InitialBlockSize;
+  arena=new google::protobuf::Arena(options);
+  frame=nullptr;
+  frame_number=-1;
+}
+
+DetectionFrameArena::~DetectionFrameArena() {
+  delete arena;
+  delete[] initial_block;
+}
+
+SSL_DetectionFrame * DetectionFrameArena::getFrame(long long number) {
+  if (frame == nullptr || number != frame_number) {
+    arena->Reset();
+    frame=google::protobuf::Arena::CreateMessage<SSL_DetectionFrame>(arena);
+    frame_number=number;
+  }
+  return frame;
+}
+
+DetectionFrameSlot::DetectionFrameSlot()
+  : FrameDataSlot<SSL_DetectionFrame>("ssl_detection_frame"), slot_arena("ssl_detection_arena") {
+}
+
+SSL_DetectionFrame * DetectionFrameSlot::getOrCreate(FrameData * data) const {
+  DetectionFrameArena * arena=slot_arena.getOrCreate(data->map);
+  SSL_DetectionFrame * frame=arena->getFrame(data->number);
+  if (get(data->map) != frame) reference(data->map, frame);
+  return frame;
+}
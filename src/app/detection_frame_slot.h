@@ -0,0 +1,80 @@
+//========================================================================
+//  This software is free: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License Version 3,
+//  as published by the Free Software Foundation.
+//
+//  This software is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  Version 3 in the file COPYING that came with this distribution.
+//  If not, see <http://www.gnu.org/licenses/>.
+//========================================================================
+/*!
+  \file    detection_frame_slot.h
+  \brief   C++ Interface: DetectionFrameArena, DetectionFrameSlot
+*/
+//========================================================================
+
+#ifndef DETECTION_FRAME_SLOT_H
+#define DETECTION_FRAME_SLOT_H
+#include <google/protobuf/arena.h>
+#include "framedata.h"
+#include "messages_robocup_ssl_detection.pb.h"
+
+/*!
+  \class   DetectionFrameArena
+  \brief   The protobuf arena the SSL_DetectionFrame of a FrameData is built in
+
+  The arena owns a fixed initial block, which is kept when the arena is
+  reset. As long as a detection frame fits into that block, building it
+  does not touch the heap at all.
+*/
+class DetectionFrameArena
+{
+protected:
+  static const size_t InitialBlockSize = 64*1024;
+  char * initial_block;
+  google::protobuf::Arena * arena;
+  SSL_DetectionFrame * frame;
+  long long frame_number;
+
+  DetectionFrameArena(const DetectionFrameArena &);
+  DetectionFrameArena & operator= (const DetectionFrameArena &);
+
+public:
+  DetectionFrameArena();
+  ~DetectionFrameArena();
+
+  /// returns the detection frame of frame \p number, starting a new one
+  /// (and freeing the previous one) if it was built for another frame
+  SSL_DetectionFrame * getFrame(long long number);
+};
+
+/*!
+  \class   DetectionFrameSlot
+  \brief   The "ssl_detection_frame" slot, as used by the plugins producing detections
+
+  The SSL_DetectionFrame stored in the slot is allocated in the
+  DetectionFrameArena of the FrameData, and is referenced (not owned) by
+  the slot. The arena is reset once the FrameData bin is reused for the
+  next frame, so the detection frame stays valid for all plugins and
+  displays reading the current frame.
+
+  Plugins which only read (or amend) the detection frame can keep using a
+  plain FrameDataSlot<SSL_DetectionFrame> with the same label.
+*/
+class DetectionFrameSlot : public FrameDataSlot<SSL_DetectionFrame>
+{
+protected:
+  FrameDataSlot<DetectionFrameArena> slot_arena;
+public:
+  DetectionFrameSlot();
+  /// returns the detection frame of \p data, starting a new one if
+  /// the slot still holds the detection frame of an earlier frame
+  SSL_DetectionFrame * getOrCreate(FrameData * data) const;
+};
+
+#endif
@@ -0,0 +1,85 @@
+//========================================================================
+//  This software is free: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License Version 3,
+//  as published by the Free Software Foundation.
+//
+//  This software is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  Version 3 in the file COPYING that came with this distribution.
+//  If not, see <http://www.gnu.org/licenses/>.
+//========================================================================
+/*!
+  \file    frame_sequencer.h
+  \brief   C++ Interface: FrameSequencer
+*/
+//========================================================================
+
+#ifndef FRAME_SEQUENCER_H
+#define FRAME_SEQUENCER_H
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+
+/*!
+  \class   FrameSequencer
+  \brief   A set of turnstiles that let concurrently processed frames pass each stage in sequence order
+
+  Frames are numbered consecutively when they are taken from the capture queue.
+  A thread that processes frame \p seq calls enter(stage, seq) before a stage
+  that must see frames in capture order and leave(stage, seq) afterwards.
+  enter() blocks until all frames before \p seq have left that stage.
+
+  As long as every sequence number passes every stage (in increasing order per
+  thread), the lowest frame in flight never waits, so the pipeline cannot deadlock.
+*/
+class FrameSequencer
+{
+protected:
+  std::mutex turn_mutex;
+  std::condition_variable turn_changed;
+  std::vector<long long> turns;
+  bool aborted = false;
+
+public:
+  /// sets the number of stages and the sequence number of the next frame
+  void reset(int stages, long long next_seq) {
+    const std::lock_guard<std::mutex> lock(turn_mutex);
+    turns.assign(stages, next_seq);
+    aborted=false;
+  }
+
+  /// waits until it is \p seq's turn in \p stage. returns false if the sequencer was aborted.
+  bool enter(int stage, long long seq) {
+    std::unique_lock<std::mutex> lock(turn_mutex);
+    turn_changed.wait(lock, [&] { return aborted || turns[stage] >= seq; });
+    return !aborted;
+  }
+
+  void leave(int stage, long long seq) {
+    {
+      const std::lock_guard<std::mutex> lock(turn_mutex);
+      if (turns[stage] <= seq) turns[stage]=seq+1;
+    }
+    turn_changed.notify_all();
+  }
+
+  /// releases all waiting threads, e.g. when processing is stopped
+  void abort() {
+    {
+      const std::lock_guard<std::mutex> lock(turn_mutex);
+      aborted=true;
+    }
+    turn_changed.notify_all();
+  }
+
+  int getStages() {
+    const std::lock_guard<std::mutex> lock(turn_mutex);
+    return (int)turns.size();
+  }
+};
+
+#endif
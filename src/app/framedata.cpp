@@ -20,6 +20,83 @@
 //========================================================================
 
 #include "framedata.h"
+#include <mutex>
+#include <cstdio>
+#include <utility>
+
+namespace {
+  struct SlotInfo {
+    int id;
+    string type_name;
+  };
+  std::mutex registry_mutex;
+  map<string, SlotInfo> registry;
+}
+
+int FrameDataMap::registerSlot(const string & label, const char * type_name) {
+  const std::lock_guard<std::mutex> lock(registry_mutex);
+  string type = (type_name == nullptr) ? "" : type_name;
+  auto iter = registry.find(label);
+  if (iter == registry.end()) {
+    int id = (int)registry.size();
+    registry[label] = SlotInfo{id, type};
+    return id;
+  }
+  if (!type.empty()) {
+    if (iter->second.type_name.empty()) {
+      iter->second.type_name = type;
+    } else if (iter->second.type_name != type) {
+      fprintf(stderr, "Warning: FrameData slot '%s' is used with different types!\n", label.c_str());
+    }
+  }
+  return iter->second.id;
+}
+
+int FrameDataMap::findSlot(const string & label) {
+  const std::lock_guard<std::mutex> lock(registry_mutex);
+  auto iter = registry.find(label);
+  if (iter == registry.end()) return -1;
+  return iter->second.id;
+}
+
+FrameDataMap::~FrameDataMap() {
+  for (auto & e : entries) {
+    release(e);
+  }
+}
+
+void FrameDataMap::release(Entry & e) {
+  if (e.item != nullptr && e.deleter != nullptr) {
+    e.deleter(e.item);
+  }
+  e.item = nullptr;
+  e.deleter = nullptr;
+}
+
+void * FrameDataMap::insert(int id, void * item, Deleter deleter) {
+  if (id < 0) return 0;
+  if (id >= (int)entries.size()) entries.resize(id + 1);
+  Entry & e = entries[id];
+  if (e.item == nullptr) {
+    e.item = item;
+    e.deleter = deleter;
+  } else if (item != e.item && deleter != nullptr) {
+    deleter(item);
+  }
+  return e.item;
+}
+
+void * FrameDataMap::update(int id, void * item, Deleter deleter) {
+  if (id < 0) return 0;
+  if (id >= (int)entries.size()) entries.resize(id + 1);
+  Entry & e = entries[id];
+  if (e.item != item) {
+    release(e);
+  }
+  e.item = item;
+  e.deleter = deleter;
+  return e.item;
+}
 
 FrameData::FrameData()
 {
@@ -31,4 +108,10 @@ FrameData::FrameData()
 
 FrameData::~FrameData() = default;
 
-
+void FrameData::swap(FrameData & other) {
+  std::swap(number, other.number);
+  std::swap(time, other.time);
+  std::swap(time_cam, other.time_cam);
+  std::swap(video, other.video);
+  map.swap(other.map);
+}
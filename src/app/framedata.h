@@ -23,8 +23,12 @@
 #ifndef FRAMEDATA_H
 #define FRAMEDATA_H
 #include "ringbuffer.h"
+#include "lockfree_ringbuffer.h"
 #include "rawimage.h"
 #include <map>
+#include <vector>
+#include <string>
+#include <typeinfo>
 using namespace std;
 
 /*!
@@ -32,26 +36,108 @@ using namespace std;
   \brief   A general storage map, for plugins to store and read their data
   \author  Stefan Zickler, (C) 2008
 
-  This class acts as a storage map of string and data-pointer pairs.
+  This class acts as a storage map of slot and data-pointer pairs.
   This allows any plugin to make its results publicly available to the
   entire image stack pipeline for the current frame.
+
+  Slots are registered once by name (usually by a FrameDataSlot in the
+  constructor of a plugin) and are then addressed by their integer id, so
+  a per-frame lookup is a plain array access.
+
+  Items inserted with a deleter are owned by the map: they are deleted when
+  they get replaced by update() and when the map is destroyed. As FrameData
+  bins of a FrameBuffer are reused, the items stay alive and are recycled
+  for the next frame written into the same bin.
 */
-class FrameDataMap : protected map<string,void *>
+class FrameDataMap
 {
 public:
+  typedef void (*Deleter)(void *);
+protected:
+  struct Entry {
+    void * item = nullptr;
+    Deleter deleter = nullptr;
+  };
+  vector<Entry> entries;
+  void release(Entry & e);
+public:
+  FrameDataMap() = default;
+  FrameDataMap(const FrameDataMap &) = delete;
+  FrameDataMap & operator=(const FrameDataMap &) = delete;
+  ~FrameDataMap();
+
+  /// returns the id of the slot \p label, registering it if it does not exist yet.
+  /// \p type_name is used to warn about slots that are used with different types.
+  static int registerSlot(const string & label, const char * type_name = nullptr);
+  /// returns the id of the slot \p label or -1 if no such slot was registered
+  static int findSlot(const string & label);
+
+  void * get(int id) const {
+    if (id < 0 || id >= (int)entries.size()) return 0;
+    return entries[id].item;
+  }
   void * get(const string & label) const {
-    map<string,void *>::const_iterator iter = map<string,void *>::find(label);
-    if (iter==map<string,void *>::end()) return 0;
-    return iter->second;
+    return get(findSlot(label));
   }
+  /// stores \p item in slot \p id, if the slot is still empty.
+  /// returns the item that is stored in the slot afterwards. If the slot
+  /// was already taken, an owned \p item is deleted.
+  void * insert(int id, void * item, Deleter deleter = nullptr);
+  /// replaces the item in slot \p id, deleting the previous one if it was owned
+  void * update(int id, void * item, Deleter deleter = nullptr);
   void * insert(const string & label, void * item) {
-    pair< map<string,void *>::iterator, bool > pair = map<string,void *>::insert ( make_pair(label,item) );
-    if (pair.first==map<string,void *>::end()) return 0;
-    return pair.first->second;
+    return insert(registerSlot(label), item);
   }
   void * update(const string & label, void * item) {
-    erase(label);
-    return insert(label, item);
+    return update(registerSlot(label), item);
+  }
+  /// exchanges all items (and their ownership) with \p other
+  void swap(FrameDataMap & other) {
+    entries.swap(other.entries);
+  }
+};
+
+/*!
+  \class   FrameDataSlot
+  \brief   A typed handle to a slot of the FrameDataMap
+
+  Create one of these per slot at construction time, e.g. as a member of
+  a plugin. All handles with the same label share the same slot.
+  Items stored through a FrameDataSlot are owned by the FrameDataMap.
+*/
+template <class T>
+class FrameDataSlot
+{
+protected:
+  int id;
+  static void destroy(void * item) {
+    delete (T *) item;
+  }
+public:
+  explicit FrameDataSlot(const string & label) {
+    id=FrameDataMap::registerSlot(label, typeid(T).name());
+  }
+  int getId() const {
+    return id;
+  }
+  T * get(const FrameDataMap & map) const {
+    return (T *) map.get(id);
+  }
+  T * insert(FrameDataMap & map, T * item) const {
+    return (T *) map.insert(id, item, &destroy);
+  }
+  T * update(FrameDataMap & map, T * item) const {
+    return (T *) map.update(id, item, &destroy);
+  }
+  /// returns the item of this slot, default-constructing it if it does not exist yet
+  T * getOrCreate(FrameDataMap & map) const {
+    T * item=get(map);
+    if (item == nullptr) item=insert(map, new T());
+    return item;
+  }
+  /// stores a pointer to an item that is owned by someone else (e.g. a plugin)
+  T * reference(FrameDataMap & map, T * item) const {
+    return (T *) map.update(id, item, nullptr);
   }
 };
 
@@ -77,12 +163,18 @@ public:
   FrameData();
 
   ~FrameData();
+
+  /// exchanges the content of two frames without copying any of their data
+  void swap(FrameData & other);
 };
 
 /*!
   \class   FrameBuffer
   \brief   A RingBuffer consisting of items of type FrameData
   \author  Stefan Zickler, (C) 2008
+
+  Any of the RingBuffer implementations can be used as a FrameBuffer,
+  e.g. the lock-free TripleBuffer or LockFreeRingBuffer.
 */
 typedef RingBuffer<FrameData> FrameBuffer;
 
@@ -25,6 +25,7 @@
 #include <QWidget>
 #include <QSlider>
 #include <QLabel>
+#include <atomic>
 #include <QListWidget>
 #include <lut3d.h>
 #include "glLUTwidget.h"
@@ -46,9 +47,14 @@ public:
     void set_status(const QString &status);
 
     int currentChannel = -1;
-    bool pending_reset = false;
-    bool pending_reset_lut = false;
-    bool pending_update = false;
+    //set on the GUI thread, carried out by the plugin on the processing thread
+    std::atomic<bool> pending_reset{false};
+    std::atomic<bool> pending_reset_lut{false};
+    std::atomic<bool> pending_update{false};
+
+    bool hasPendingCommands() const {
+      return pending_reset || pending_reset_lut || pending_update;
+    }
 
 public slots:
 
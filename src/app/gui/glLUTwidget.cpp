@@ -1125,9 +1125,23 @@ void GLLUTWidget::sampleImage(const RawImage & img, ConvexHullImageMask & mask)
           color_uyvy++;
           mask_pixel+=2;
         }
+    } else if (source_format==COLOR_RAW8) {
+      //one sample per bayer quad, with the color the thresholding sees
+      int w=img.getWidth();
+      int h=img.getHeight();
+      for (int y=0;y<h;y+=2) {
+        for (int x=0;x<w;x+=2) {
+          color=Conversions::rgb2yuv(Conversions::bayer2rgb(img.getData(),w,h,x,y));
+          i=_lut->norm2lutX(color.y);
+          if (i >= 0 && i < (int)slices.size() && mask_pixel[y*w + x] != 0) {
+            drawSample(i,_lut->norm2lutY(color.u),_lut->norm2lutZ(color.v));
+            slices[i]->sampler_update_pending=true;
+          }
+        }
+      }
     } else {
       fprintf(stderr,"Unable to sample colors from frame of format: %s\n",Colors::colorFormatToString(source_format).c_str());
-      fprintf(stderr,"Currently supported are rgb8, yuv444, and yuv422 (UYVY).\n");
+      fprintf(stderr,"Currently supported are rgb8, yuv444, yuv422 (UYVY), and raw8 (Bayer).\n");
       fprintf(stderr,"(Feel free to add more conversions to glLUTwidget.cpp).\n");
     }
    }
@@ -34,7 +34,7 @@ void GLWidget::mouseAction ( QMouseEvent * event, pixelloc loc ) {
       rb->lockRead();
       int idx=rb->curRead();
       FrameData * frame = rb->getPointer ( idx );
-      VisualizationFrame * vis_frame=(VisualizationFrame *)(frame->map.get("vis_frame"));
+      VisualizationFrame * vis_frame=slot_vis_frame.get(frame->map);
       if (vis_frame!=0 && vis_frame->valid==true) {
 
         rgbImage & img = vis_frame->data;
@@ -85,7 +85,8 @@ void GLWidget::paintGL() {
   mainDraw();
 }
 
-GLWidget::GLWidget ( QWidget *parent , bool allow_qpainter_overlay) : QGLWidget ( allow_qpainter_overlay ? QGLFormat(QGL::SampleBuffers) : QGLFormat(), parent ) {
+GLWidget::GLWidget ( QWidget *parent , bool allow_qpainter_overlay) : QGLWidget ( allow_qpainter_overlay ? QGLFormat(QGL::SampleBuffers) : QGLFormat(), parent ),
+  slot_vis_frame ( "vis_frame" ), slot_capture_stats ( "capture_stats" ) {
   ALLOW_QPAINTER=allow_qpainter_overlay;
   rb_bb=0;
   rb=0;
@@ -251,7 +252,7 @@ void GLWidget::myGLdraw() {
         rb->lockRead();
         int idx=rb->curRead();
         FrameData * frame = rb->getPointer ( idx );
-        VisualizationFrame * vis_frame=(VisualizationFrame *)(frame->map.get("vis_frame"));
+        VisualizationFrame * vis_frame=slot_vis_frame.get(frame->map);
         if (vis_frame!=0 && vis_frame->valid==true && vis_frame->data.getData() != 0 && vis_frame->data.getWidth() >= 1 && vis_frame->data.getHeight() >=1 ) {
           rgbImage & img = vis_frame->data;
           if ( img.getWidth() > 1 && img.getHeight() > 1 ) {
@@ -382,7 +383,7 @@ void GLWidget::saveImage() {
     int idx=rb->curRead();
     FrameData * frame = rb->getPointer ( idx );
 
-    VisualizationFrame * vis_frame=(VisualizationFrame *)(frame->map.get("vis_frame"));
+    VisualizationFrame * vis_frame=slot_vis_frame.get(frame->map);
     if (vis_frame !=0 && vis_frame->valid) {
       temp.copy ( vis_frame->data );
       rb->unlockRead();
@@ -79,6 +79,9 @@ protected:
 
   RingBuffer<FrameData> * rb_bb;
 
+  FrameDataSlot<VisualizationFrame> slot_vis_frame;
+  FrameDataSlot<CaptureStats> slot_capture_stats;
+
 public:
   virtual QSize sizeHint() const {
     QSize size;
@@ -99,6 +102,7 @@ public:
   void setVisionStack(VisionStack * _stack)
   {
     stack=_stack;
+    if (stack!=0) stack->setDisplayed(isVisible());
   }
   void setObjectName(const QString & s)
   {
@@ -107,6 +111,19 @@ public:
   GLWidget(QWidget *parent = 0, bool allow_qpainter_overlay=true);
   virtual ~GLWidget();
 
+  //the stack only draws its visualization while it is shown
+  virtual void showEvent ( QShowEvent * event )
+  {
+    if (stack!=0) stack->setDisplayed(true);
+    QGLWidget::showEvent(event);
+  }
+
+  virtual void hideEvent ( QHideEvent * event )
+  {
+    if (stack!=0) stack->setDisplayed(false);
+    QGLWidget::hideEvent(event);
+  }
+
   virtual void focusInEvent ( QFocusEvent * event )
   {
     (void)event;
@@ -147,7 +164,7 @@ public:
       last_frame=rb->getPointer(cur)->number;
 
       FrameData * frame = rb->getPointer(cur);
-      CaptureStats * cstats = (CaptureStats *)frame->map.get("capture_stats");
+      CaptureStats * cstats = slot_capture_stats.get(frame->map);
       if (cstats != 0) {
         stats.capture_stats=(*cstats);
       }
@@ -21,11 +21,17 @@
 
 #include "mainwindow.h"
 
-MainWindow::MainWindow(bool start_capture, bool enforce_affinity, int num_cameras)
+MainWindow::MainWindow(bool start_capture, bool enforce_affinity, bool realtime_capture, int num_cameras)
 {
 
   affinity=0;
-  if (enforce_affinity) affinity=new AffinityManager();
+  if (enforce_affinity) {
+    affinity=new AffinityManager();
+    affinity->setCameraCount(num_cameras);
+    affinity->setRealtimeCapture(realtime_capture);
+    //threads created by the GUI thread (and the stacks created below) inherit this placement
+    affinity->demandAuxiliaryCores();
+  }
   //opt=new GetOpt();
   settings=0;
   setupUi((QMainWindow *)this);
@@ -125,8 +131,6 @@ MainWindow::MainWindow(bool start_capture, bool enforce_affinity, int num_camera
     cam_tabs->addTab(stack_widget, label);
   }
 
-  if (affinity!=0) affinity->demandCore(multi_stack->threads.size());
-
   // Set position and size of main window:
   QSettings window_settings("RoboCup", "ssl-vision");
   window_settings.beginGroup("MainWindow");
@@ -179,7 +183,9 @@ MainWindow::MainWindow(bool start_capture, bool enforce_affinity, int num_camera
 
   setCentralWidget(splitter); //was splitter
 
-  startTimer(10);
+  startFrameWatchers();
+  //new frames are signaled by the frame watchers, the timer only keeps the idle displays and the statistics up to date
+  startTimer(100);
 
   // connection must be queued as the data tree is locked
   // by a mutex when the signal is triggered
@@ -197,25 +203,62 @@ void MainWindow::resizeEvent(QResizeEvent *event) {
 
 void MainWindow::timerEvent( QTimerEvent * e) {
   (void)e;
-  unsigned int n = display_widgets.size();
-  RealTimeDisplayWidget * w;
-  bool frame_changed;
-  FrameBuffer * fb;
+  for (unsigned int i=0;i<display_widgets.size();i++) {
+    updateDisplay(i,false);
+  }
+  multi_stack->publishStatistics();
+}
+
+void MainWindow::slotFrameReady(int i) {
+  //reset first, so that a frame arriving during the redraw triggers the next event
+  display_pending[i]=false;
+  updateDisplay(i,true);
+}
+
+void MainWindow::updateDisplay(int i, bool check_frame) {
+  RealTimeDisplayWidget * w = display_widgets[i];
+  bool frame_changed=false;
+  FrameBuffer * fb=w->getRingBuffer();
+  if (check_frame && fb!=0) {
+    fb->lockRead();
+    int cur=fb->curRead();
+    if (fb->nextRead(true) != cur) frame_changed=true;
+    fb->unlockRead();
+  }
+  w->displayLoopEvent(frame_changed,opts);
+}
+
+void MainWindow::watchFrames(int i) {
+  FrameBuffer * fb=display_widgets[i]->getRingBuffer();
+  unsigned long seen=fb->getWriteCount();
+  while (watching_frames) {
+    //the timeout only bounds the time it takes to notice stopFrameWatchers()
+    if (fb->waitForWrite(seen,100) && !display_pending[i].exchange(true)) {
+      QMetaObject::invokeMethod(this, "slotFrameReady", Qt::QueuedConnection, Q_ARG(int, i));
+    }
+  }
+}
 
+void MainWindow::startFrameWatchers() {
+  unsigned int n = display_widgets.size();
+  display_pending.reset(new std::atomic<bool>[n]);
+  watching_frames=true;
   for (unsigned int i=0;i<n;i++) {
-    w = display_widgets[i];
-    frame_changed=false;
-    fb=w->getRingBuffer();
-    if (fb!=0) {
-      fb->lockRead();
-      int cur=fb->curRead();
-      if (fb->nextRead(true) != cur) frame_changed=true;
-      fb->unlockRead();
+    display_pending[i]=false;
+    if (display_widgets[i]->getRingBuffer()!=0) {
+      frame_watchers.emplace_back(&MainWindow::watchFrames, this, (int)i);
     }
-    w->displayLoopEvent(frame_changed,opts);
   }
 }
 
+void MainWindow::stopFrameWatchers() {
+  watching_frames=false;
+  for (auto & t : frame_watchers) {
+    if (t.joinable()) t.join();
+  }
+  frame_watchers.clear();
+}
+
 void MainWindow::slotSaveSettings()
 {
     VarXML::write(world,"settings.xml");
@@ -239,6 +282,7 @@ void MainWindow::closeEvent(QCloseEvent * event ) {
 }
 
 MainWindow::~MainWindow() {
+  stopFrameWatchers();
   if (affinity!=0) delete affinity;
   //FIXME: right now we don't clean up anything
   VarXML::write(world,"settings.xml");
@@ -40,6 +40,9 @@
 #include "stacks.h"
 #include "qgetopt.h"
 #include "multistacks.h"
+#include <thread>
+#include <atomic>
+#include <memory>
 /*!
   \class   MainWindow
   \brief   The ssl-vision main window
@@ -68,7 +71,17 @@ public:
 
   MultiVisionStack * multi_stack;
 
-  MainWindow(bool start_capture, bool enforce_affinity, int num_cameras);
+  //one thread per display widget waits for new frames and posts slotFrameReady().
+  //display_pending suppresses further events until the previous one was handled.
+  std::vector<std::thread> frame_watchers;
+  std::unique_ptr<std::atomic<bool>[]> display_pending;
+  std::atomic<bool> watching_frames;
+  void watchFrames(int i);
+  void startFrameWatchers();
+  void stopFrameWatchers();
+  void updateDisplay(int i, bool check_frame);
+
+  MainWindow(bool start_capture, bool enforce_affinity, bool realtime_capture, int num_cameras);
   virtual ~MainWindow();
   void init();
   void Quit() { emit close(); }
@@ -80,6 +93,7 @@ public:
 
 public slots:
   void slotSaveSettings();
+  void slotFrameReady(int i);
 };
 
 #endif // MAINWINDOW_H
@@ -43,9 +43,9 @@ class RealTimeDisplayWidget {
     FrameBuffer * getRingBuffer();
     void setRingBuffer(FrameBuffer * _rb);
 
-    //this function will be called about 1000 times/s on your visualization plugin
+    //this function will be called whenever a new frame was written to the ring buffer
+    //(with frame_changed==true), and periodically with frame_changed==false.
     //in most cases you might want to only trigger a render if frame_changed==true
-    //which should occur with the same frequency as your camera input
     virtual void displayLoopEvent(bool frame_changed, RenderOptions * opts);
 
 };
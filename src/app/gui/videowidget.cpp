@@ -186,6 +186,9 @@ void VideoWidget::processVideoStats(VideoStats stats)
   //our display-widget as thrown us a stat-update event
   //let's display it
   statLabel->setText(
-    "Capture: "+ QString::number(stats.capture_stats.fps_capture,'f',2)  + " fps | Display: " + QString::number(stats.fps_draw,'f',2) + " fps | "
+    "Capture: "+ QString::number(stats.capture_stats.fps_capture,'f',2)  + " fps"
+    + " (arrival " + QString::number(stats.capture_stats.fps_arrival,'f',2) + " fps, "
+    + QString::number(stats.capture_stats.dropped) + " dropped, "
+    + QString::number(stats.capture_stats.queue_age*1000.0,'f',1) + " ms old) | Display: " + QString::number(stats.fps_draw,'f',2) + " fps | "
     + QString::number(stats.fps_loop,'f',2) + " its/s");
 }
@@ -27,6 +27,8 @@
 #include <iostream>
 #include <unistd.h>
 #include "qgetopt.h"
+#include "image_buffer_pool.h"
+#include "affinity_manager.h"
 
 MainWindow* mainWinPtr = NULL;
 
@@ -90,11 +92,17 @@ int main(int argc, char *argv[])
   bool help=false;
   bool start=false;
   bool enforce_affinity=false;
+  bool realtime_capture=false;
+  bool huge_pages=false;
+  bool verbose=false;
   QString camera_count;
   int ecode=0;
   opts.addSwitch("help",&help);
   opts.addShortOptSwitch( 'a',QString("Enforce Processor Affinity"),&enforce_affinity, false);
+  opts.addShortOptSwitch( 'r',QString("Real-time Priority for Capture Threads"),&realtime_capture, false);
+  opts.addShortOptSwitch( 'p',QString("Huge Pages for Image Buffers"),&huge_pages, false);
   opts.addShortOptSwitch( 's',QString("Start Capturing Immediately"),&start, false);
+  opts.addShortOptSwitch( 'v',QString("Verbose Thread Placement"),&verbose, false);
   opts.addOptionalOption( 'c',QString("Camera Count"),&camera_count, QString("4"));
   if (!opts.parse()) {
     fprintf(stderr,"Invalid command line parameters!\n");
@@ -114,14 +122,24 @@ int main(int argc, char *argv[])
     printf("SSL-Vision command line options:\n");
     printf(" -s        Start capture immediately\n");
     printf(" -a        Set Processor Affinity\n");
+    printf(" -r        Run capture threads with real-time priority (requires -a)\n");
+    printf(" -p        Back large image buffers with transparent huge pages\n");
     printf(" -c <n>    Set Number of Cameras\n");
+    printf(" -v        Print the placement of every thread (with -a)\n");
     printf(" --help    Show this help\n");
     exit(ecode);
   }
 
   printPathWarning();
 
-  MainWindow mainWin(start, enforce_affinity, num_cameras);
+  if (realtime_capture && !enforce_affinity) {
+    fprintf(stderr,"Real-time priority (-r) is only applied together with processor affinity (-a)\n");
+  }
+
+  ImageBufferPool::getInstance().setHugePages(huge_pages);
+  AffinityManager::setVerbose(verbose);
+
+  MainWindow mainWin(start, enforce_affinity, realtime_capture, num_cameras);
   mainWinPtr = &mainWin;
   mainWin.show();
   mainWin.init();
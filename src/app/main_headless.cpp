@@ -0,0 +1,201 @@
+//========================================================================
+//  This software is free: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License Version 3,
+//  as published by the Free Software Foundation.
+//
+//  This software is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  Version 3 in the file COPYING that came with this distribution.
+//  If not, see <http://www.gnu.org/licenses/>.
+//========================================================================
+/*!
+  \file    main_headless.cpp
+  \brief   The entry point of ssl-vision without graphical user interface.
+
+  Loads the same settings.xml as the graphical application, but only
+  constructs the processing plugins and never creates any widget.
+
+  Signals:
+   SIGINT, SIGTERM  stop capturing and exit
+   SIGUSR1          start capturing on all cameras
+   SIGUSR2          stop capturing on all cameras
+*/
+//========================================================================
+
+#include <QCoreApplication>
+#include <QTimer>
+#include <QString>
+#include <signal.h>
+#include <stdio.h>
+#include "qgetopt.h"
+#include "VarTypes.h"
+#include "multistack_robocup_ssl.h"
+#include "affinity_manager.h"
+#include "image_buffer_pool.h"
+
+static volatile sig_atomic_t pending_quit = 0;
+static volatile sig_atomic_t pending_start = 0;
+static volatile sig_atomic_t pending_stop = 0;
+
+static void HandleSignal(int sig) {
+  if (sig == SIGUSR1) {
+    pending_start = 1;
+  } else if (sig == SIGUSR2) {
+    pending_stop = 1;
+  } else {
+    pending_quit = 1;
+  }
+}
+
+/// builds the same data-tree as the MainWindow, so that settings.xml can be shared
+static VarList * buildSettingsTree(MultiStackRoboCupSSL * multi_stack) {
+  VarList * root=new VarList("Vision System");
+  root->addChild(new VarTrigger("Save Settings", "Save Settings!"));
+
+  VarExternal * stackvar;
+  root->addChild(stackvar= new VarExternal((multi_stack->getSettingsFileName() + ".xml").c_str(),multi_stack->getName()));
+  stackvar->addChild(multi_stack->getSettings());
+  for (unsigned int i=0;i<multi_stack->threads.size();i++) {
+    VisionStack * s = multi_stack->threads[i]->getStack();
+    QString label = "Thread " + QString::number(i);
+#ifdef CAMERA_SPLITTER
+    if(i == multi_stack->threads.size() - 1)
+    {
+      label = "Distributor Thread";
+    }
+#endif
+    VarList * threadvar = new VarList(label.toStdString());
+    threadvar->addChild(s->getSettings());
+    threadvar->addChild(multi_stack->threads[i]->getSettings());
+
+    for (auto p : s->stack) {
+      if (p->getSettings()==0) continue;
+      if (p->isSharedAmongStacks()) {
+        if (i==0) stackvar->addChild(p->getSettings());
+      } else {
+        threadvar->addChild(p->getSettings());
+      }
+    }
+    stackvar->addChild(threadvar);
+  }
+  return root;
+}
+
+int main(int argc, char *argv[])
+{
+  QCoreApplication app(argc, argv);
+
+  GetOpt opts(argc, argv);
+  bool help=false;
+  bool start=false;
+  bool enforce_affinity=false;
+  bool realtime_capture=false;
+  bool huge_pages=false;
+  bool verbose=false;
+  QString camera_count;
+  int ecode=0;
+  opts.addSwitch("help",&help);
+  opts.addShortOptSwitch( 'a',QString("Enforce Processor Affinity"),&enforce_affinity, false);
+  opts.addShortOptSwitch( 'r',QString("Real-time Priority for Capture Threads"),&realtime_capture, false);
+  opts.addShortOptSwitch( 'p',QString("Huge Pages for Image Buffers"),&huge_pages, false);
+  opts.addShortOptSwitch( 's',QString("Start Capturing Immediately"),&start, false);
+  opts.addShortOptSwitch( 'v',QString("Verbose Thread Placement"),&verbose, false);
+  opts.addOptionalOption( 'c',QString("Camera Count"),&camera_count, QString("4"));
+  if (!opts.parse()) {
+    fprintf(stderr,"Invalid command line parameters!\n");
+    help=true;
+    ecode=1;
+  }
+
+  bool camera_count_ok = false;
+  int num_cameras = camera_count.toInt(&camera_count_ok);
+  if(!camera_count_ok) {
+    fprintf(stderr,"Invalid number of cameras!\n");
+    help=true;
+    ecode=1;
+  }
+
+  if (help) {
+    printf("SSL-Vision (headless) command line options:\n");
+    printf(" -s        Start capture immediately\n");
+    printf(" -a        Set Processor Affinity\n");
+    printf(" -r        Run capture threads with real-time priority (requires -a)\n");
+    printf(" -p        Back large image buffers with transparent huge pages\n");
+    printf(" -c <n>    Set Number of Cameras\n");
+    printf(" -v        Print the placement of every thread (with -a)\n");
+    printf(" --help    Show this help\n");
+    printf("Signals: SIGUSR1 starts, SIGUSR2 stops capturing, SIGINT/SIGTERM exit.\n");
+    exit(ecode);
+  }
+
+  signal(SIGINT,HandleSignal);
+  signal(SIGTERM,HandleSignal);
+  signal(SIGUSR1,HandleSignal);
+  signal(SIGUSR2,HandleSignal);
+
+  if (realtime_capture && !enforce_affinity) {
+    fprintf(stderr,"Real-time priority (-r) is only applied together with processor affinity (-a)\n");
+  }
+
+  ImageBufferPool::getInstance().setHugePages(huge_pages);
+  AffinityManager::setVerbose(verbose);
+
+  AffinityManager * affinity=0;
+  if (enforce_affinity) {
+    affinity=new AffinityManager();
+    affinity->setCameraCount(num_cameras);
+    affinity->setRealtimeCapture(realtime_capture);
+    //threads created by the main thread (and the stacks created below) inherit this placement
+    affinity->demandAuxiliaryCores();
+  }
+
+  RenderOptions opts_render;
+  MultiStackRoboCupSSL * multi_stack = new MultiStackRoboCupSSL(&opts_render, num_cameras, true);
+  if (affinity!=0) {
+    for (auto t : multi_stack->threads) {
+      t->setAffinityManager(affinity);
+    }
+  }
+
+  vector<VarType *> world;
+  world.push_back(buildSettingsTree(multi_stack));
+  world=VarXML::read(world,"settings.xml");
+
+  multi_stack->RefreshNetworkOutput();
+  multi_stack->RefreshLegacyNetworkOutput();
+  multi_stack->start();
+
+  if (start) pending_start=1;
+
+  //signal handlers only set flags, which are handled here on the main thread
+  QTimer signal_timer;
+  QObject::connect(&signal_timer, &QTimer::timeout, [&]() {
+    if (pending_start) {
+      pending_start=0;
+      for (auto t : multi_stack->threads) t->init();
+    }
+    if (pending_stop) {
+      pending_stop=0;
+      for (auto t : multi_stack->threads) t->stop();
+    }
+    if (pending_quit) {
+      printf("\nExiting.\n");
+      fflush(stdout);
+      app.quit();
+    }
+    multi_stack->publishStatistics();
+  });
+  signal_timer.start(100);
+
+  int retval = app.exec();
+
+  //settings.xml is owned by the graphical application, so it is never written here
+  multi_stack->stop();
+  delete multi_stack;
+  if (affinity!=0) delete affinity;
+  return retval;
+}
@@ -32,6 +32,8 @@ PluginAutoColorCalibration::PluginAutoColorCalibration(
         VisionPlugin(_buffer),
         global_lut(lut),
         lutw(_lutw) {
+  // only handles GUI commands, which may reset or recalibrate the LUT
+  declareWrite("lut");
 
   settings = new VarList("Auto Color Calibration");
   v_calibration_points = new VarList("Calibration Points");
@@ -75,6 +77,10 @@ QWidget *PluginAutoColorCalibration::getControlWidget() {
 }
 
 
+bool PluginAutoColorCalibration::isActive() const {
+  return (accw != nullptr && accw->hasPendingCommands()) || hasMarkedCalibrationPoints();
+}
+
 ProcessResult PluginAutoColorCalibration::process(FrameData *frame, RenderOptions *options) {
   (void) options;
   if (frame == nullptr) {
@@ -215,6 +221,17 @@ void PluginAutoColorCalibration::removeMarkedCalibrationPoints() {
   }
 }
 
+bool PluginAutoColorCalibration::hasMarkedCalibrationPoints() const {
+  for (VarType *v_child : v_calibration_points->getChildren()) {
+    for (auto *c : v_child->getChildren()) {
+      if (c->getName() == "Remove" && ((VarTrigger *) c)->getCounter() > 0) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
 float PluginAutoColorCalibration::getWeight(int channel) {
   VarDouble *v_weight = weightMap[channel];
   float weight = 1;
@@ -56,6 +56,9 @@ public:
     ~PluginAutoColorCalibration() override;
 
     ProcessResult process(FrameData *data, RenderOptions *options) override;
+    /// the plugin only carries out the commands of its widget and its "Remove" triggers,
+    /// so it is active while one of them is pending
+    bool isActive() const override;
 
     QWidget *getControlWidget() override;
 
@@ -96,6 +99,8 @@ private:
 
     void removeMarkedCalibrationPoints();
 
+    bool hasMarkedCalibrationPoints() const;
+
     void runCalibration();
 };
 
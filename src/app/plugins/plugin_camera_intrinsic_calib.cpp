@@ -12,7 +12,14 @@ PluginCameraIntrinsicCalibration::PluginCameraIntrinsicCalibration(FrameBuffer *
     : VisionPlugin(buffer),
       settings(new VarList("Camera Intrinsic Calibration")),
       widget(new CameraIntrinsicCalibrationWidget(_camera_params)),
-      camera_params(_camera_params) {
+      camera_params(_camera_params),
+      slot_img_calibration("img_calibration"),
+      slot_chessboard("chessboard"),
+      slot_chessboard_img_points("chessboard_img_points") {
+  declareRead("frame_video");
+  declareWrite(slot_img_calibration);
+  declareWrite(slot_chessboard);
+  declareWrite(slot_chessboard_img_points);
   worker = new PluginCameraIntrinsicCalibrationWorker(_camera_params, widget);
 
   chessboard_capture_dt = new VarDouble("chessboard capture dT", 0.2);
@@ -53,23 +60,23 @@ std::string PluginCameraIntrinsicCalibration::getName() { return "Camera Intrins
 
 QWidget *PluginCameraIntrinsicCalibration::getControlWidget() { return static_cast<QWidget *>(worker->widget); }
 
+bool PluginCameraIntrinsicCalibration::isActive() const {
+  return widget->patternDetectionEnabled() || widget->isCapturing() || widget->should_load_images ||
+         widget->should_calibrate || widget->should_clear_data;
+}
+
 ProcessResult PluginCameraIntrinsicCalibration::process(FrameData *data, RenderOptions *options) {
   (void)options;
 
-  Image<raw8> *img_calibration;
-  if ((img_calibration = reinterpret_cast<Image<raw8> *>(data->map.get("img_calibration"))) == nullptr) {
-    img_calibration = reinterpret_cast<Image<raw8> *>(data->map.insert("img_calibration", new Image<raw8>()));
-  }
+  Image<raw8> *img_calibration = slot_img_calibration.getOrCreate(data->map);
 
   ConversionsGreyscale::cvColor2Grey(data->video, img_calibration);
 
-  Chessboard *chessboard;
-  if ((chessboard = reinterpret_cast<Chessboard *>(data->map.get("chessboard"))) == nullptr) {
-    chessboard = reinterpret_cast<Chessboard *>(data->map.insert("chessboard", new Chessboard()));
-  }
+  Chessboard *chessboard = slot_chessboard.getOrCreate(data->map);
 
-  if (data->map.get("chessboard_img_points") == nullptr) {
-    data->map.insert("chessboard_img_points", &worker->image_points);
+  // the image points are owned by the worker, the map only references them
+  if (slot_chessboard_img_points.get(data->map) == nullptr) {
+    slot_chessboard_img_points.reference(data->map, &worker->image_points);
   }
 
   // cv expects row major order and image stores col major.
@@ -99,6 +99,8 @@ public:
   QWidget *getControlWidget() override;
 
   ProcessResult process(FrameData *data, RenderOptions *options) override;
+  /// active while the pattern is detected or captured, or a command of the widget is pending
+  bool isActive() const override;
   VarList *getSettings() override;
   std::string getName() override;
 
@@ -116,4 +118,8 @@ private:
   VarDouble *chessboard_capture_dt;
 
   double lastChessboardCaptureFrame = 0.0;
+
+  FrameDataSlot<Image<raw8>> slot_img_calibration;
+  FrameDataSlot<Chessboard> slot_chessboard;
+  FrameDataSlot<std::vector<std::vector<cv::Point2f>>> slot_chessboard_img_points;
 };
@@ -23,8 +23,10 @@
 #include "conversions.h"
 #include "sobel.h"
 #include <algorithm>
+#ifndef VISION_HEADLESS
 #include <QTabWidget>
 #include <QStackedWidget>
+#endif
 
 using std::swap;
 
@@ -35,6 +37,9 @@ PluginCameraCalibration::PluginCameraCalibration(
     field(_field),
     ccw(nullptr), grey_image(nullptr), rgb_image(nullptr), drag_x(nullptr),
     drag_y(nullptr), calib_drag_x(nullptr), calib_drag_y(nullptr) {
+  declareRead("frame_video");
+  //sets the image size and the detected calibration edges
+  declareWrite("camera_parameters");
   video_width=video_height=0;
   settings=new VarList("Camera Calibrator");
   settings->addChild(camera_settings = new VarList("Camera Parameters"));
@@ -115,14 +120,17 @@ ProcessResult PluginCameraCalibration::process(
       camera_parameters.additional_calibration_information->imageHeight->setInt(video_height);
   }
   (void)options;
+#ifndef VISION_HEADLESS
   if(ccw) {
     if(ccw->getDetectEdges()) {
       detectEdges(data);
       // detectEdges2(data);
       ccw->resetDetectEdges();
     }
-    ccw->set_slider_from_vars();
+    //the image size above is needed by everyone, the sliders only by a visible widget
+    if (isDisplayed()) ccw->set_slider_from_vars();
   }
+#endif
   return ProcessingOk;
 }
 
@@ -135,10 +143,14 @@ string PluginCameraCalibration::getName() {
 }
 
 QWidget * PluginCameraCalibration::getControlWidget() {
+#ifdef VISION_HEADLESS
+  return 0;
+#else
   if (ccw==0)
     ccw = new CameraCalibrationWidget(camera_parameters);
 
   return (QWidget *)ccw;
+#endif
 }
 
 void PluginCameraCalibration::sanitizeSobel(
@@ -289,6 +301,10 @@ void PluginCameraCalibration::keyPressEvent ( QKeyEvent * event )
 
 void PluginCameraCalibration::mousePressEvent ( QMouseEvent * event, pixelloc loc )
 {
+#ifdef VISION_HEADLESS
+  (void)loc;
+  event->ignore();
+#else
   auto tabw = (QTabWidget*) ccw->parentWidget()->parentWidget();
   double drag_threshold = 20; //in px
   if (tabw->currentWidget() == ccw && (event->buttons() & Qt::LeftButton)!=0) {
@@ -326,11 +342,15 @@ void PluginCameraCalibration::mousePressEvent ( QMouseEvent * event, pixelloc lo
     }
   }
   event->ignore();
+#endif
 }
 
 void PluginCameraCalibration::mouseReleaseEvent ( QMouseEvent * event, pixelloc loc )
 {
   (void)loc;
+#ifdef VISION_HEADLESS
+  event->ignore();
+#else
   auto tabw = (QTabWidget*) ccw->parentWidget()->parentWidget();
   if (tabw->currentWidget() == ccw)
   {
@@ -342,10 +362,15 @@ void PluginCameraCalibration::mouseReleaseEvent ( QMouseEvent * event, pixelloc
   }
   else
     event->ignore();
+#endif
 }
 
 void PluginCameraCalibration::mouseMoveEvent ( QMouseEvent * event, pixelloc loc )
 {
+#ifdef VISION_HEADLESS
+  (void)loc;
+  event->ignore();
+#else
   auto tabw = (QTabWidget*) ccw->parentWidget()->parentWidget();
   if (tabw->currentWidget() == ccw && (event->buttons() & Qt::LeftButton)!=0)
   {
@@ -365,4 +390,5 @@ void PluginCameraCalibration::mouseMoveEvent ( QMouseEvent * event, pixelloc loc
   }
   else
     event->ignore();
+#endif
 }
@@ -27,7 +27,11 @@
 #include "camera_calibration.h"
 #include "field.h"
 #include "image.h"
+#ifndef VISION_HEADLESS
 #include "cameracalibwidget.h"
+#endif
+
+class CameraCalibrationWidget;
 
 /**
 *	@author Tim Laue <Tim.Laue@dfki.de>
@@ -25,6 +25,8 @@
 PluginColorCalibration::PluginColorCalibration(FrameBuffer * _buffer, YUVLUT * _lut, ConvexHullImageMask &mask, LUTChannelMode _mode)
 : VisionPlugin(_buffer), _image_mask(mask)
 {
+    //the LUT is edited through the widget, which must not race with its readers
+    declareWrite("lut");
     mode=_mode;
     lut=_lut;
     lutw=NULL;
@@ -96,6 +98,10 @@ void PluginColorCalibration::mouseEvent( QMouseEvent * event, pixelloc loc) {
             } else if (source_format==COLOR_YUV444) {
               yuvImage img(frame->video);
               color=img.getPixel(loc.x,loc.y);
+            } else if (source_format==COLOR_RAW8) {
+              //the color the thresholding sees for this pixel's bayer quad
+              color=Conversions::rgb2yuv(Conversions::bayer2rgb(frame->video.getData(),
+                                         frame->video.getWidth(),frame->video.getHeight(),loc.x,loc.y));
             } else if (source_format==COLOR_YUV422_UYVY) {
               uyvy color2 = *((uyvy*)(frame->video.getData() + (sizeof(uyvy) * (((loc.y * (frame->video.getWidth())) + loc.x) / 2))));
               color.u=color2.u;
@@ -108,7 +114,7 @@ void PluginColorCalibration::mouseEvent( QMouseEvent * event, pixelloc loc) {
             } else {
               //blank it:
               fprintf(stderr,"Unable to pick color from frame of format: %s\n",Colors::colorFormatToString(source_format).c_str());
-              fprintf(stderr,"Currently supported are rgb8, yuv444, and yuv422 (UYVY).\n");
+              fprintf(stderr,"Currently supported are rgb8, yuv444, yuv422 (UYVY), and raw8 (Bayer).\n");
               fprintf(stderr,"(Feel free to add more conversions to plugin_colorcalib.cpp).\n");
             }
             lutw->samplePixel(color);
@@ -19,151 +19,208 @@
 */
 //========================================================================
 #include "plugin_colorthreshold.h"
-
-static void thresholdImage(RawImage *imagePartIn, Image<raw8> *imagePartOut, YUVLUT * lut, const ImageInterface* mask = nullptr) {
-  if (imagePartIn->getColorFormat() == COLOR_YUV422_UYVY) {
-    CMVisionThreshold::thresholdImageYUV422_UYVY(imagePartOut, imagePartIn, lut, mask);
-  } else if (imagePartIn->getColorFormat() == COLOR_YUV444) {
-    CMVisionThreshold::thresholdImageYUV444(imagePartOut, imagePartIn, lut, mask);
-  } else if (imagePartIn->getColorFormat() == COLOR_RGB8) {
-    auto *rgblut = (RGBLUT *) lut->getDerivedLUT(CSPACE_RGB);
-    if (rgblut == nullptr) {
-      printf("WARNING: No RGB LUT has been defined. You need to create a derived RGB LUT by calling e.g. \"lut_yuv->addDerivedLUT(new RGBLUT(5,5,5,\"\"))\" in the stack constructor!\n");
-    } else {
-      CMVisionThreshold::thresholdImageRGB(imagePartOut, imagePartIn, rgblut, mask);
-    }
-  } else {
-    fprintf(stderr, "ColorThresholding needs YUV422, YUV444, or RGB8 as input image, but found: %s\n",
-            Colors::colorFormatToString(imagePartIn->getColorFormat()).c_str());
-  }
-}
-
-PluginColorThresholdWorker::PluginColorThresholdWorker(int _id, int _totalThreads, YUVLUT * _lut) : QObject() {
-
-  this->id = _id;
-  this->totalThreads = _totalThreads;
-  this->lut = _lut;
-
-  thread = new QThread();
-  thread->setObjectName("ColorThreshold");
-  moveToThread(thread);
-  connect(this, SIGNAL(startThresholding()), this, SLOT(process()));
-  thread->start();
-}
-
-PluginColorThresholdWorker::~PluginColorThresholdWorker() {
-  thread->quit();
-  thread->deleteLater();
+#include "image_difference.h"
+#include <algorithm>
+#include <string.h>
+
+/// thresholds the rows [\p first_row, \p last_row) of the image. Pixels outside
+/// of \p spans are cleared without looking them up.
+static void thresholdRows(RawImage * imageIn, const ConvexHullImageMask & mask, const MaskSpans * spans,
+                          Image<raw8> * imageOut, YUVLUT * lut, int first_row, int last_row) {
+  raw8 * target = imageOut->getPixelData() + first_row * imageOut->getWidth();
+  CMVisionThreshold::thresholdRows(target, imageIn, lut, &mask.getMask(), first_row, last_row, spans);
 }
 
-
-void PluginColorThresholdWorker::process() {
-  RawImage imagePartIn;
-  imagePartIn.setColorFormat(imageIn->getColorFormat());
-  imagePartIn.setHeight(imageIn->getHeight()/totalThreads);
-  imagePartIn.setWidth(imageIn->getWidth());
-  int offsetBytesIn = id * imageIn->getNumBytes() / totalThreads;
-  imagePartIn.setData(imageIn->getData() + offsetBytesIn);
-
-  RawImage maskImagePartIn;
-  maskImagePartIn.setColorFormat(maskImageIn->getColorFormat());
-  maskImagePartIn.setHeight(maskImageIn->getHeight()/totalThreads);
-  maskImagePartIn.setWidth(maskImageIn->getWidth());
-  int maskOffsetBytesIn = id * maskImageIn->getNumBytes() /  totalThreads;
-  maskImagePartIn.setData(maskImageIn->getData() + maskOffsetBytesIn);
-
-  RawImage rawImageOut;
-  rawImageOut.setColorFormat(imageOut->getColorFormat());
-  rawImageOut.setHeight(imageOut->getHeight()/totalThreads);
-  rawImageOut.setWidth(imageOut->getWidth());
-  int offsetBytesOut = id * imageOut->getNumBytes() / totalThreads;
-  rawImageOut.setData(imageOut->getData() + offsetBytesOut);
-  Image<raw8> imagePartOut;
-  imagePartOut.fromRawImage(rawImageOut);
-
-  thresholdImage(&imagePartIn, &imagePartOut, lut, &maskImagePartIn);
-
-  doneMutex.unlock();
-}
-
-
-void PluginColorThresholdWorker::start() {
-  doneMutex.lock();
-  emit startThresholding();
+// the source, mask and target rows of a tile should fit into the cache of the core thresholding it
+static const int TileBytes = 128*1024;
+// tiles are made smaller if needed to give every thread several of them, which evens out busy and masked rows
+static const int MinTilesPerThread = 4;
+
+/// the number of rows of the tiles \p threads threads claim from \p imageIn
+static int tileRows(const RawImage * imageIn, int threads) {
+  int height = imageIn->getHeight();
+  int row_bytes = std::max(1, imageIn->getNumBytes() / std::max(1, height) + 2 * imageIn->getWidth());
+  int rows = std::max(1, TileBytes / row_bytes);
+  return std::min(rows, std::max(1, height / (threads * MinTilesPerThread)));
 }
 
-
-void PluginColorThresholdWorker::wait() {
-  doneMutex.lock();
-  doneMutex.unlock();
+/// copies the rectangle [\p x0, \p x1) x [\p y0, \p y1) between two label images of \p width pixels per row
+static void copyRect(raw8 * target, const raw8 * source, int width, int x0, int y0, int x1, int y1) {
+  size_t offset=(size_t)y0 * width + x0;
+  for (int y=y0;y<y1;y++, offset+=width) {
+    memcpy(target + offset, source + offset, (x1 - x0) * sizeof(raw8));
+  }
 }
 
 
-PluginColorThreshold::PluginColorThreshold(FrameBuffer * _buffer, YUVLUT * _lut, ConvexHullImageMask &mask)
-  : VisionPlugin(_buffer), _image_mask(mask)
+PluginColorThreshold::PluginColorThreshold(FrameBuffer * _buffer, YUVLUT * _lut, ConvexHullImageMask &mask,
+                                           const PluginRunlengthEncode * _fused_encoder)
+  : VisionPlugin(_buffer), _image_mask(mask),
+    snapshot([this](Settings & s) {
+      s.threads=numThreads->getInt();
+      s.skip_unchanged=skipUnchanged->getBool();
+      s.change_threshold=changeThreshold->getInt();
+      s.refresh_frames=refreshFrames->getInt();
+    }),
+    slot_threshold("cmv_threshold"), slot_roi("roi_spans"), fused_encoder(_fused_encoder),
+    reference_format(COLOR_UNDEFINED), reference_width(0), reference_height(0),
+    reference_mask_revision(-1), reference_lut_revision(-1), refresh_countdown(0), fraction_recomputed(1.0)
 {
+  declareRead("frame_video");
+  declareRead("image_mask");
+  declareRead("lut");
+  declareRead(slot_roi);
+  declareWrite(slot_threshold);
   lut=_lut;
 
   settings=new VarList("Color Threshold");
+  //number of threads thresholding tiles of rows on the shared task pool (0 or 1: no splitting)
   numThreads = new VarInt("number of threads", 0, 0, 32);
   settings->addChild(numThreads);
+  //only the 16x16 blocks whose bytes changed since they were last thresholded are thresholded again
+  skipUnchanged = new VarBool("skip unchanged blocks", false);
+  settings->addChild(skipUnchanged);
+  //the mean absolute difference per byte above which a block counts as changed
+  changeThreshold = new VarInt("block change threshold", 4, 0, 255);
+  settings->addChild(changeThreshold);
+  //the whole frame is thresholded every that many frames, which bounds how long a missed change persists
+  refreshFrames = new VarInt("full refresh (frames)", 30, 1, 10000);
+  settings->addChild(refreshFrames);
+
+  fractionRecomputed = new VarDouble("fraction of blocks recomputed", 1.0);
+  fractionRecomputed->addFlags(VARTYPE_FLAG_READONLY | VARTYPE_FLAG_NOSTORE);
+  settings->addChild(fractionRecomputed);
+  snapshot.watch(settings);
 }
 
 
 PluginColorThreshold::~PluginColorThreshold()
 {
-  clearWorkers();
   delete settings;
 }
 
-void PluginColorThreshold::clearWorkers() {
-  for (auto worker : workers) {
-    worker->deleteLater();
-  }
-  workers.clear();
+
+int PluginColorThreshold::getNumThreads() const {
+  return snapshot.get()->threads;
 }
 
+bool PluginColorThreshold::isActive() const {
+  return fused_encoder == nullptr || !fused_encoder->isFused();
+}
 
 ProcessResult PluginColorThreshold::process(FrameData * data, RenderOptions * options) {
   _image_mask.lock();
   (void)options;
 
-  Image<raw8> * img_thresholded;
-
-  if ((img_thresholded=(Image<raw8> *)data->map.get("cmv_threshold")) == nullptr) {
-    img_thresholded=(Image<raw8> *)data->map.insert("cmv_threshold",new Image<raw8>());
-  }
+  Image<raw8> * img_thresholded = slot_threshold.getOrCreate(data->map);
 
   //make sure image is allocated:
   img_thresholded->allocate(data->video.getWidth(),data->video.getHeight());
 
-  if((int) workers.size() != numThreads->getInt()) {
-    clearWorkers();
-    for(int i=0;i<numThreads->getInt();i++) {
-      auto *worker = new PluginColorThresholdWorker(i, numThreads->getInt(), lut);
-      workers.push_back(worker);
-    }
-  }
+  //only the region of interest is thresholded if there is one
+  const RegionOfInterestSpans * roi = slot_roi.get(data->map);
+  const MaskSpans * spans = (roi != nullptr && roi->active) ? &roi->spans : &_image_mask.getSpans();
 
-  if(workers.empty()) {
-    thresholdImage(&data->video, img_thresholded, lut, &_image_mask.getMask());
+  SettingsSnapshot<Settings>::Reader s=snapshot.get();
+  double fraction=1.0;
+  if (s->skip_unchanged && (roi == nullptr || !roi->active)) {
+    fraction=thresholdChangedBlocks(data, img_thresholded, *s);
   } else {
-    for (auto worker : workers) {
-      worker->imageIn = &data->video;
-      worker->maskImageIn = &_image_mask.getMask();
-      worker->imageOut = img_thresholded;
-      worker->start();
-    }
-
-    for (auto worker : workers) {
-      worker->wait();
-    }
+    thresholdFrame(data, img_thresholded, spans, s->threads);
+    //a region of interest leaves the rest of the result cleared, so the blocks start over
+    refresh_countdown=0;
   }
+  fraction_recomputed=0.9 * fraction_recomputed + 0.1 * fraction;
 
   _image_mask.unlock();
   return ProcessingOk;
 }
 
+void PluginColorThreshold::thresholdFrame(FrameData * data, Image<raw8> * img_thresholded, const MaskSpans * spans, int threads) {
+  //the threads claim tiles of rows until all rows are thresholded
+  int tile_rows=threads > 1 ? tileRows(&data->video, threads) : data->video.getHeight();
+  TaskPool::getInstance().claimRanges(threads, data->video.getHeight(), tile_rows, [&](int, int first, int last) {
+    thresholdRows(&data->video, _image_mask, spans, img_thresholded, lut, first, last);
+  });
+}
+
+double PluginColorThreshold::thresholdChangedBlocks(FrameData * data, Image<raw8> * img_thresholded, const Settings & s) {
+  const RawImage & video=data->video;
+  int width=video.getWidth();
+  int height=video.getHeight();
+  int source_bytes=video.getNumBytes();
+  raw8 * target=img_thresholded->getPixelData();
+  const unsigned char * source=video.getData();
+
+  //read first, so that an edit of the LUT during the refresh causes another one
+  int lut_revision=lut->getRevision();
+  refresh_countdown--;
+  if (refresh_countdown <= 0 || video.getColorFormat() != reference_format ||
+      width != reference_width || height != reference_height ||
+      _image_mask.getRevision() != reference_mask_revision || lut_revision != reference_lut_revision ||
+      (int)reference.size() != source_bytes) {
+    thresholdFrame(data, img_thresholded, &_image_mask.getSpans(), s.threads);
+    reference.assign(source, source + source_bytes);
+    labels.assign(target, target + (size_t)width * height);
+    reference_format=video.getColorFormat();
+    reference_width=width;
+    reference_height=height;
+    reference_mask_revision=_image_mask.getRevision();
+    reference_lut_revision=lut_revision;
+    refresh_countdown=s.refresh_frames;
+    return 1.0;
+  }
+
+  //column x starts at byte x * row_bytes / width of a row, which keeps the
+  //4-byte UYVY pairs of the (even) block columns together
+  int row_bytes=source_bytes / std::max(1, height);
+  int blocks_x=(width + BlockSize - 1) / BlockSize;
+  int blocks_y=(height + BlockSize - 1) / BlockSize;
+  std::atomic<int> recomputed(0);
+  TaskPool::getInstance().claimRanges(s.threads, blocks_y, 1, [&](int, int first, int last) {
+    std::vector<bool> changed(blocks_x);
+    for (int by=first;by<last;by++) {
+      int y0=by * BlockSize;
+      int y1=std::min(y0 + BlockSize, height);
+      for (int bx=0;bx<blocks_x;bx++) {
+        int x0=bx * BlockSize;
+        int x1=std::min(x0 + BlockSize, width);
+        int b0=x0 * row_bytes / width;
+        int b1=x1 * row_bytes / width;
+        size_t offset=(size_t)y0 * row_bytes + b0;
+        unsigned int sad=ImageDifference::sadBlock(source + offset, reference.data() + offset, b1 - b0, y1 - y0, row_bytes);
+        changed[bx]=sad > (unsigned int)s.change_threshold * (b1 - b0) * (y1 - y0);
+      }
+      //neighbouring blocks in the same state are handled as one rectangle
+      for (int bx=0;bx<blocks_x;) {
+        int end=bx + 1;
+        while (end < blocks_x && changed[end] == changed[bx]) end++;
+        int x0=bx * BlockSize;
+        int x1=std::min(end * BlockSize, width);
+        if (changed[bx]) {
+          CMVisionThreshold::thresholdRect(target, &video, lut, &_image_mask.getMask(), x0, y0, x1, y1);
+          copyRect(labels.data(), target, width, x0, y0, x1, y1);
+          //unchanged blocks keep their reference, so that slow drifts still add up to a change
+          for (int y=y0;y<y1;y++) {
+            size_t b0=(size_t)y * row_bytes + x0 * row_bytes / width;
+            size_t b1=(size_t)y * row_bytes + x1 * row_bytes / width;
+            memcpy(reference.data() + b0, source + b0, b1 - b0);
+          }
+          recomputed+=end - bx;
+        } else {
+          copyRect(target, labels.data(), width, x0, y0, x1, y1);
+        }
+        bx=end;
+      }
+    }
+  });
+  return (double)recomputed / (blocks_x * blocks_y);
+}
+
+void PluginColorThreshold::publishStatistics() {
+  fractionRecomputed->setDouble(fraction_recomputed);
+}
+
 VarList * PluginColorThreshold::getSettings() {
   return settings;
 }
@@ -24,35 +24,13 @@
 #include <visionplugin.h>
 #include "lut3d.h"
 #include "cmvision_threshold.h"
-#include <mutex>
-#include <QThread>
-#include <QObject>
 #include "convex_hull_image_mask.h"
-
-class PluginColorThresholdWorker : public QObject {
-Q_OBJECT
-public:
-    PluginColorThresholdWorker(int id, int totalThreads, YUVLUT * lut);
-    ~PluginColorThresholdWorker() override;
-    QThread* thread;
-    int id;
-    int totalThreads;
-    RawImage* imageIn = nullptr;
-    const ImageInterface* maskImageIn = nullptr;
-    Image<raw8>* imageOut = nullptr;
-    YUVLUT * lut;
-    std::mutex doneMutex;
-
-    void start();
-    void wait();
-
-public slots:
-    void process();
-
-signals:
-    void startThresholding();
-
-};
+#include "task_pool.h"
+#include "settings_snapshot.h"
+#include "plugin_runlength_encode.h"
+#include "plugin_region_of_interest.h"
+#include <atomic>
+#include <vector>
 
 /**
 	@author Stefan Zickler
@@ -64,20 +42,60 @@ protected:
   ConvexHullImageMask& _image_mask;
   VarList * settings;
   VarInt * numThreads;
+  VarBool * skipUnchanged;
+  VarInt * changeThreshold;
+  VarInt * refreshFrames;
+  VarDouble * fractionRecomputed;
+  struct Settings {
+    int threads;
+    bool skip_unchanged;
+    int change_threshold;
+    int refresh_frames;
+  };
+  SettingsSnapshot<Settings> snapshot;
+  FrameDataSlot<Image<raw8> > slot_threshold;
+  FrameDataSlot<RegionOfInterestSpans> slot_roi;
+  const PluginRunlengthEncode * fused_encoder;
+
+  //the blocks are compared to the source bytes they were last thresholded from,
+  //and the labels of unchanged blocks are copied from the previous result.
+  //changes of the image mask or the LUT revision force a full refresh.
+  static const int BlockSize = 16;
+  std::vector<unsigned char> reference;
+  std::vector<raw8> labels;
+  ColorFormat reference_format;
+  int reference_width;
+  int reference_height;
+  int reference_mask_revision;
+  int reference_lut_revision;
+  int refresh_countdown;
+  //the moving average of the fraction of blocks thresholded, see publishStatistics()
+  std::atomic<double> fraction_recomputed;
+
+  /// thresholds all rows of the frame, restricted to \p spans
+  void thresholdFrame(FrameData * data, Image<raw8> * img_thresholded, const MaskSpans * spans, int threads);
+  /// thresholds the blocks of the frame which changed since they were last thresholded.
+  /// returns the fraction of the blocks which were thresholded.
+  double thresholdChangedBlocks(FrameData * data, Image<raw8> * img_thresholded, const Settings & s);
 public:
-  PluginColorThreshold(FrameBuffer * _buffer, YUVLUT * _lut, ConvexHullImageMask& mask);
+  /// thresholding is skipped while \p _fused_encoder thresholds the frames itself
+  PluginColorThreshold(FrameBuffer * _buffer, YUVLUT * _lut, ConvexHullImageMask& mask,
+                       const PluginRunlengthEncode * _fused_encoder = nullptr);
 
     ~PluginColorThreshold() override;
 
+    /// the number of threads thresholding a frame, which a fused encoder uses as well
+    int getNumThreads() const;
+
+    bool isActive() const override;
+
     ProcessResult process(FrameData * data, RenderOptions * options) override;
 
+    void publishStatistics() override;
+
     VarList * getSettings() override;
 
     string getName() override;
-private:
-    std::vector<PluginColorThresholdWorker*> workers;
-
-    void clearWorkers();
 };
 
 #endif
@@ -22,7 +22,13 @@
 #include "plugin_detect_balls.h"
 
 PluginDetectBalls::PluginDetectBalls ( FrameBuffer * _buffer, LUT3D * lut, const CameraParameters& camera_params, const RoboCupField& field,PluginDetectBallsSettings * settings )
-    : VisionPlugin ( _buffer ), camera_parameters ( camera_params ), field ( field ) {
+    : VisionPlugin ( _buffer ), camera_parameters ( camera_params ), field ( field ),
+      slot_colorlist ( "cmv_colorlist" ), slot_threshold ( "cmv_threshold" ) {
+  declareRead ( slot_colorlist );
+  declareRead ( slot_threshold );
+  declareRead ( "lut" );
+  declareRead ( "camera_parameters" );
+  declareWrite ( slot_detection_frame );
   _lut=lut;
 
   _settings=settings;
@@ -110,10 +116,7 @@ ProcessResult PluginDetectBalls::process ( FrameData * data, RenderOptions * opt
   ( void ) options;
   if ( data==0 ) return ProcessingFailed;
 
-  SSL_DetectionFrame * detection_frame = 0;
-
-  detection_frame= ( SSL_DetectionFrame * ) data->map.get ( "ssl_detection_frame" );
-  if ( detection_frame == 0 ) detection_frame= ( SSL_DetectionFrame * ) data->map.insert ( "ssl_detection_frame",new SSL_DetectionFrame() );
+  SSL_DetectionFrame * detection_frame = slot_detection_frame.getOrCreate ( data );
 
   int color_id_ball = _lut->getChannelID ( _settings->_color_label->getString() );
   if ( color_id_ball == -1 ) {
@@ -169,7 +172,7 @@ ProcessResult PluginDetectBalls::process ( FrameData * data, RenderOptions * opt
 
   //acquire orange region list from data-map:
   CMVision::ColorRegionList * colorlist;
-  colorlist= ( CMVision::ColorRegionList * ) data->map.get ( "cmv_colorlist" );
+  colorlist= slot_colorlist.get ( data->map );
   if ( colorlist==0 ) {
     printf ( "error in ball detection plugin: no region-lists were found!\n" );
     return ProcessingFailed;
@@ -177,7 +180,7 @@ ProcessResult PluginDetectBalls::process ( FrameData * data, RenderOptions * opt
   reg = colorlist->getRegionList ( color_id_ball ).getInitialElement();
 
   //acquire color-labeled image from data-map:
-  const Image<raw8> * image = ( Image<raw8> * ) ( data->map.get ( "cmv_threshold" ) );
+  const Image<raw8> * image = slot_threshold.get ( data->map );
   if ( image==0 ) {
     printf ( "error in ball detection plugin: no color-thresholded image was found!\n" );
     return ProcessingFailed;
@@ -187,7 +190,7 @@ ProcessResult PluginDetectBalls::process ( FrameData * data, RenderOptions * opt
   int robots_yellow_n=0;
   bool use_near_robot_filter=near_robot_filter;
   if ( use_near_robot_filter ) {
-    SSL_DetectionFrame * detection_frame = ( SSL_DetectionFrame * ) data->map.get ( "ssl_detection_frame" );
+    SSL_DetectionFrame * detection_frame = slot_detection_frame.get ( data->map );
     if ( detection_frame==0 ) {
       use_near_robot_filter=false;
     } else {
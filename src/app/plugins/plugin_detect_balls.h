@@ -24,6 +24,7 @@
 #include <visionplugin.h>
 #include "cmvision_region.h"
 #include "messages_robocup_ssl_detection.pb.h"
+#include "detection_frame_slot.h"
 #include "camera_calibration.h"
 #include "field_filter.h"
 #include "cmvision_histogram.h"
@@ -111,6 +112,10 @@ public:
   VarList * getSettings() {
     return _settings;
   }
+  /// whether the ball detection reads the thresholded image
+  bool isHistogramEnabled() const {
+    return _ball_histogram_enabled->getBool();
+  }
 
 };
 
@@ -158,6 +163,10 @@ protected:
 
   FieldFilter field_filter;
 
+  DetectionFrameSlot slot_detection_frame;
+  FrameDataSlot<CMVision::ColorRegionList> slot_colorlist;
+  FrameDataSlot<Image<raw8> > slot_threshold;
+
   bool checkHistogram(const Image<raw8> * image, const CMVision::Region * reg, double min_greenness=0.5, double max_markeryness=2.0);
 
 public:
@@ -21,8 +21,16 @@
 #include "plugin_detect_robots.h"
 
 PluginDetectRobots::PluginDetectRobots(FrameBuffer * _buffer, LUT3D * lut, const CameraParameters& camera_params, const RoboCupField& field, CMPattern::TeamSelector * _global_team_selector_blue, CMPattern::TeamSelector * _global_team_selector_yellow, CMPattern::TeamDetectorSettings * _global_team_settings)
- : VisionPlugin(_buffer), camera_parameters(camera_params), field(field)
+ : VisionPlugin(_buffer), camera_parameters(camera_params), field(field),
+   slot_colorlist("cmv_colorlist"), slot_threshold("cmv_threshold"),
+   slot_scratch("robot_detection_scratch")
 {
+  declareRead(slot_colorlist);
+  declareRead(slot_threshold);
+  declareRead("lut");
+  declareRead("camera_parameters");
+  declareWrite(slot_detection_frame);
+  declareWrite(slot_scratch);
   _lut=lut;
 
   color_id_yellow = _lut->getChannelID("Yellow");
@@ -45,8 +53,7 @@ PluginDetectRobots::PluginDetectRobots(FrameBuffer * _buffer, LUT3D * lut, const
   global_team_selector_yellow=_global_team_selector_yellow;
   global_team_detector_settings=_global_team_settings;
 
-  team_detector_blue=new CMPattern::TeamDetector(_lut,camera_params,field);
-  team_detector_yellow=new CMPattern::TeamDetector(_lut,camera_params,field);
+  settings_generation=1;
 
   _settings=new VarList("Robot Detection");
   _notifier.addRecursive(_settings);
@@ -68,7 +75,11 @@ string PluginDetectRobots::getName() {
   return "DetectRobots";
 }
 
-void PluginDetectRobots::buildRegionTree(CMVision::ColorRegionList * colorlist) {
+bool PluginDetectRobots::isFrameParallel() const {
+  return true;
+}
+
+void PluginDetectRobots::buildRegionTree(CMVision::ColorRegionList * colorlist, CMVision::RegionTree & reg_tree) {
   reg_tree.clear();
   int num_colors=colorlist->getNumColorRegions();
   for(int c=0;c<num_colors;c++) {
@@ -89,21 +100,18 @@ ProcessResult PluginDetectRobots::process(FrameData * data, RenderOptions * opti
   (void)options;
   if (data==0) return ProcessingFailed;
 
-  SSL_DetectionFrame * detection_frame = 0;
-
-  detection_frame=(SSL_DetectionFrame *)data->map.get("ssl_detection_frame");
-  if (detection_frame == 0) detection_frame=(SSL_DetectionFrame *)data->map.insert("ssl_detection_frame",new SSL_DetectionFrame());
+  SSL_DetectionFrame * detection_frame = slot_detection_frame.getOrCreate(data);
 
   //acquire orange region list from data-map:
   CMVision::ColorRegionList * colorlist;
-  colorlist=(CMVision::ColorRegionList *)data->map.get("cmv_colorlist");
+  colorlist=slot_colorlist.get(data->map);
   if (colorlist==0) {
     printf("error in robot detection plugin: no region-lists were found!\n");
     return ProcessingFailed;
   }
 
   //acquire color-labeled image from data-map:
-  const Image<raw8> * image = (Image<raw8> *)(data->map.get("cmv_threshold"));
+  const Image<raw8> * image = slot_threshold.get(data->map);
   if (image==0) {
     printf("error in robot detection plugin: no color-thresholded image was found!\n");
     return ProcessingFailed;
@@ -117,8 +125,14 @@ ProcessResult PluginDetectRobots::process(FrameData * data, RenderOptions * opti
   CMPattern::TeamDetector * detector;
   //TODO: lookup color label from LUT
 
-  buildRegionTree(colorlist);
-  bool need_reinit=_notifier.hasChanged();
+  RobotDetectionScratch * scratch=slot_scratch.get(data->map);
+  if (scratch==0) scratch=slot_scratch.insert(data->map,new RobotDetectionScratch(_lut,camera_parameters,field));
+
+  buildRegionTree(colorlist, scratch->reg_tree);
+  if (_notifier.hasChanged()) settings_generation++;
+  unsigned int generation=settings_generation;
+  bool need_reinit=(scratch->settings_generation != generation);
+  scratch->settings_generation=generation;
 
   for (int team_i = 0; team_i < 2; team_i++) {
     //team_i: 0==blue, 1==yellow
@@ -128,21 +142,21 @@ ProcessResult PluginDetectRobots::process(FrameData * data, RenderOptions * opti
       num_robots=global_team_selector_blue->getNumberRobots();
       detection_frame->clear_robots_blue();
       robotlist=detection_frame->mutable_robots_blue();
-      detector=team_detector_blue;
+      detector=&scratch->team_detector_blue;
     } else {
       color_id=color_id_yellow;
       team=global_team_selector_yellow->getSelectedTeam();
       num_robots=global_team_selector_yellow->getNumberRobots();
       detection_frame->clear_robots_yellow();
       robotlist=detection_frame->mutable_robots_yellow();
-      detector=team_detector_yellow;
+      detector=&scratch->team_detector_yellow;
     }
     if (team!=0) {
       if (need_reinit) {
         detector->init(global_team_detector_settings->getRobotPattern(), team);
       }
 
-      detector->update(robotlist, color_id,  num_robots, image, colorlist, reg_tree);
+      detector->update(robotlist, color_id,  num_robots, image, colorlist, scratch->reg_tree);
     } else {
       _notifier.changeSlotOtherChange();
     }
@@ -24,6 +24,7 @@
 #include <visionplugin.h>
 #include "cmvision_region.h"
 #include "messages_robocup_ssl_detection.pb.h"
+#include "detection_frame_slot.h"
 #include "camera_calibration.h"
 #include "field_filter.h"
 #include "cmvision_histogram.h"
@@ -32,9 +33,29 @@
 #include "vis_util.h"
 #include "lut3d.h"
 #include "VarNotifier.h"
+#include <atomic>
 /**
 	@author Author Name
 */
+/*!
+  \class   RobotDetectionScratch
+  \brief   The per-frame working memory of PluginDetectRobots
+
+  This is kept in the FrameDataMap, so that several frames can be
+  processed by the same plugin at the same time.
+*/
+class RobotDetectionScratch
+{
+public:
+  CMVision::RegionTree reg_tree;
+  CMPattern::TeamDetector team_detector_blue;
+  CMPattern::TeamDetector team_detector_yellow;
+  unsigned int settings_generation;
+
+  RobotDetectionScratch(LUT3D * lut, const CameraParameters& camera_params, const RoboCupField& field)
+    : team_detector_blue(lut,camera_params,field), team_detector_yellow(lut,camera_params,field), settings_generation(0) {}
+};
+
 class PluginDetectRobots : public VisionPlugin
 {
 protected:
@@ -50,21 +71,24 @@ protected:
   int color_id_ball;
   int color_id_black;
   int color_id_field;
-  
 
-  CMVision::RegionTree reg_tree;
 
   CMPattern::TeamDetectorSettings * global_team_detector_settings;
   CMPattern::TeamSelector * global_team_selector_blue;
   CMPattern::TeamSelector * global_team_selector_yellow;
 
-  CMPattern::TeamDetector * team_detector_blue;
-  CMPattern::TeamDetector * team_detector_yellow;
+  //incremented whenever the team settings change, so that every scratch re-initializes its detectors
+  std::atomic<unsigned int> settings_generation;
 
   const CameraParameters& camera_parameters;
   const RoboCupField& field;
 
-  void buildRegionTree(CMVision::ColorRegionList * colorlist);
+  DetectionFrameSlot slot_detection_frame;
+  FrameDataSlot<CMVision::ColorRegionList> slot_colorlist;
+  FrameDataSlot<Image<raw8> > slot_threshold;
+  FrameDataSlot<RobotDetectionScratch> slot_scratch;
+
+  void buildRegionTree(CMVision::ColorRegionList * colorlist, CMVision::RegionTree & reg_tree);
 
 protected slots:
     void teamDataChange();
@@ -73,6 +97,8 @@ public:
 
     ~PluginDetectRobots();
 
+    virtual bool isFrameParallel() const;
+
     virtual ProcessResult process(FrameData * data, RenderOptions * options);
     virtual VarList * getSettings();
     virtual string getName();
@@ -18,7 +18,8 @@
 
 PluginDistribute::PluginDistribute(FrameBuffer *_buffer, vector<CaptureSplitter *> captureSplitters)
     : VisionPlugin(_buffer),
-      captureSplitters(std::move(captureSplitters)) {
+      captureSplitters(std::move(captureSplitters)),
+      slot_vis_frame("vis_frame") {
   _v_enabled = new VarBool("enable", true);
   _v_image = new VarBool("image", true);
   _v_greyscale = new VarBool("greyscale", false);
@@ -82,12 +83,7 @@ ProcessResult PluginDistribute::process(FrameData *data, RenderOptions *options)
     captureSplitter->waitUntilFrameProcessed();
   }
 
-  VisualizationFrame *vis_frame =
-      reinterpret_cast<VisualizationFrame *>(data->map.get("vis_frame"));
-  if (vis_frame == nullptr) {
-    vis_frame = reinterpret_cast<VisualizationFrame *>(
-        data->map.insert("vis_frame", new VisualizationFrame()));
-  }
+  VisualizationFrame *vis_frame = slot_vis_frame.getOrCreate(data->map);
 
   if (_v_enabled->getBool()) {
     // check video data...
@@ -30,6 +30,8 @@ protected:
 
   std::vector<CaptureSplitter*> captureSplitters;
 
+  FrameDataSlot<VisualizationFrame> slot_vis_frame;
+
   void drawCameraImage(FrameData *data, VisualizationFrame *vis_frame);
 
 public:
@@ -19,6 +19,7 @@
 */
 //========================================================================
 #include "plugin_dvr.h"
+#include "affinity_manager.h"
 
 #include <google/protobuf/util/json_util.h>
 #include <chrono>
@@ -425,8 +426,12 @@ void PluginDVR::slotMovieSave() {
 }
 
 PluginDVR::PluginDVR(FrameBuffer * fb)
- : VisionPlugin(fb)
+ : VisionPlugin(fb), slot_detection_frame("ssl_detection_frame")
 {
+  //playback replaces the video, recording stores the previous detection of this frame bin
+  declareRead("frame_video");
+  declareWrite("frame_video");
+  declareRead(slot_detection_frame);
   mode = DVRModeOff;
   advance_last_t=0;
   seek_mode = SeekModeLive;
@@ -473,6 +478,10 @@ void DVRFrame::getFromFrameData(FrameData * data) {
   video.deepCopyFromRawImage(data->video,true);
 }
 
+bool PluginDVR::isActive() const {
+  return mode != DVRModeOff || isDisplayed();
+}
+
 ProcessResult PluginDVR::process(FrameData * data, RenderOptions * options) {
 
   using namespace std::chrono;
@@ -497,7 +506,7 @@ ProcessResult PluginDVR::process(FrameData * data, RenderOptions * options) {
       stream.setLimit(_max_frames->getInt());
 
       // Get detection frame connected to frame
-      SSL_DetectionFrame* detection_frame = (SSL_DetectionFrame *)data->map.get("ssl_detection_frame");
+      SSL_DetectionFrame* detection_frame = slot_detection_frame.get(data->map);
 
       // If recording is on, store the frame and possible detection_frame in the ringbuffers
       if (is_recording) {
@@ -824,7 +833,12 @@ int DVRThreadSafeQueue::size() {
 
 DVRNonBlockingWriter::DVRNonBlockingWriter(QString output_dir): output_dir(std::move(output_dir)){
   std::cout << "[DVRNonBlockingWriter] New instance" << std::endl;
-  writer_thread = std::thread(&DVRNonBlockingWriter::runWriterOnLoop, this);
+  //the writer is created from a processing thread, but must not compete with it for its cores
+  AffinityManager::Placement placement=AffinityManager::getPlacement();
+  writer_thread = std::thread([this, placement]() {
+    placement.demandAuxiliaryCores();
+    runWriterOnLoop();
+  });
 }
 
 DVRNonBlockingWriter::~DVRNonBlockingWriter() {
@@ -235,6 +235,8 @@ protected:
   // but is not available in c++11
   std::unique_ptr<DVRNonBlockingWriter> frame_writer;
 
+  FrameDataSlot<SSL_DetectionFrame> slot_detection_frame;
+
 public:
 
   PluginDVR(FrameBuffer * fb);
@@ -243,6 +245,8 @@ public:
   virtual string getName();
   virtual QWidget * getControlWidget();
   virtual ProcessResult process(FrameData * data, RenderOptions * options);
+  /// active while recording or playing back, or while the status is displayed
+  bool isActive() const override;
 };
 
 #endif
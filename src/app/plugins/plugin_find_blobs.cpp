@@ -21,8 +21,19 @@
 #include "plugin_find_blobs.h"
 
 PluginFindBlobs::PluginFindBlobs(FrameBuffer * _buffer, YUVLUT * _lut)
- : VisionPlugin(_buffer)
+ : VisionPlugin(_buffer),
+   snapshot([this](Settings & s) {
+     s.min_blob_area=_v_min_blob_area->getInt();
+     s.min_blob_area_ratio=_v_min_blob_area_ratio->getDouble();
+     s.enable=_v_enable->getBool();
+     s.max_regions=v_max_regions->getInt();
+   }),
+   slot_reglist("cmv_reglist"), slot_colorlist("cmv_colorlist"), slot_runlist("cmv_runlist")
 {
+  declareRead(slot_runlist);
+  declareRead("lut");
+  declareWrite(slot_reglist);
+  declareWrite(slot_colorlist);
   lut=_lut;
 
   _settings=new VarList("Blob Finding");
@@ -30,7 +41,7 @@ PluginFindBlobs::PluginFindBlobs(FrameBuffer * _buffer, YUVLUT * _lut)
   _settings->addChild(_v_min_blob_area_ratio=new VarDouble("min_blob_area ratio", 0.5));
   _settings->addChild(_v_enable=new VarBool("enable", true));
   _settings->addChild(v_max_regions=new VarInt("max regions", 50000, 10000, 1000000));
-
+  snapshot.watch(_settings);
 }
 
 
@@ -47,26 +58,25 @@ PluginFindBlobs::~PluginFindBlobs()
 
 ProcessResult PluginFindBlobs::process(FrameData * data, RenderOptions * options) {
   (void)options;
+  SettingsSnapshot<Settings>::Reader s=snapshot.get();
 
-
-  CMVision::RegionList * reglist = (CMVision::RegionList *) data->map.get("cmv_reglist");
-  if (reglist == nullptr || reglist->getMaxRegions() != v_max_regions->getInt()) {
-    delete reglist;
-    reglist = (CMVision::RegionList *) data->map.update("cmv_reglist", new CMVision::RegionList(v_max_regions->getInt()));
+  CMVision::RegionList * reglist = slot_reglist.get(data->map);
+  if (reglist == nullptr || reglist->getMaxRegions() != s->max_regions) {
+    reglist = slot_reglist.update(data->map, new CMVision::RegionList(s->max_regions));
   }
 
-  CMVision::ColorRegionList * colorlist = (CMVision::ColorRegionList *) data->map.get("cmv_colorlist");
+  CMVision::ColorRegionList * colorlist = slot_colorlist.get(data->map);
   if (colorlist == nullptr) {
-    colorlist = (CMVision::ColorRegionList *) data->map.insert("cmv_colorlist", new CMVision::ColorRegionList(lut->getChannelCount()));
+    colorlist = slot_colorlist.insert(data->map, new CMVision::ColorRegionList(lut->getChannelCount()));
   }
 
-  CMVision::RunList * runlist = (CMVision::RunList *) data->map.get("cmv_runlist");
+  CMVision::RunList * runlist = slot_runlist.get(data->map);
   if (runlist == nullptr) {
     printf("Blob finder: no runlength-encoded input list was found!\n");
     return ProcessingFailed;
   }
 
-  if (_v_enable->getBool()) {
+  if (s->enable) {
     //Connect the components of the runlength map:
     CMVision::RegionProcessing::connectComponents(runlist);
 
@@ -78,7 +88,7 @@ ProcessResult PluginFindBlobs::process(FrameData * data, RenderOptions * options
     }
 
     //Separate Regions by colors:
-    int max_area = CMVision::RegionProcessing::separateRegions(colorlist, reglist, _v_min_blob_area->getInt(), _v_min_blob_area_ratio->getDouble());
+    int max_area = CMVision::RegionProcessing::separateRegions(colorlist, reglist, s->min_blob_area, s->min_blob_area_ratio);
 
     //Sort Regions:
     CMVision::RegionProcessing::sortRegions(colorlist,max_area);
@@ -105,3 +115,7 @@ VarList * PluginFindBlobs::getSettings() {
 string PluginFindBlobs::getName() {
   return "FindBlobs";
 }
+
+bool PluginFindBlobs::isFrameParallel() const {
+  return true;
+}
@@ -24,6 +24,7 @@
 #include <visionplugin.h>
 #include "lut3d.h"
 #include "cmvision_region.h"
+#include "settings_snapshot.h"
 /**
 	@author Stefan Zickler
 */
@@ -37,6 +38,16 @@ protected:
   VarDouble * _v_min_blob_area_ratio;
   VarBool * _v_enable;
   VarInt * v_max_regions;
+  struct Settings {
+    int min_blob_area;
+    double min_blob_area_ratio;
+    bool enable;
+    int max_regions;
+  };
+  SettingsSnapshot<Settings> snapshot;
+  FrameDataSlot<CMVision::RegionList> slot_reglist;
+  FrameDataSlot<CMVision::ColorRegionList> slot_colorlist;
+  FrameDataSlot<CMVision::RunList> slot_runlist;
 public:
     PluginFindBlobs(FrameBuffer * _buffer, YUVLUT * _lut);
 
@@ -44,6 +55,8 @@ public:
 
     ProcessResult process(FrameData * data, RenderOptions * options) override;
 
+    bool isFrameParallel() const override;
+
     VarList * getSettings() override;
 
     string getName() override;
@@ -51,6 +51,8 @@ PluginLegacyPublishGeometry::PluginLegacyPublishGeometry(
     VisionPlugin(fb),
     _ds_udp_server_old(ds_udp_server_old),
     _field(field) {
+  //the geometry includes the calibration of the cameras
+  declareRead("camera_parameters");
   setSharedAmongStacks(true);
   _settings=new VarList("Publish Legacy Geometry");
   _settings->addChild(_pub=new VarTrigger("Publish","Publish!"));
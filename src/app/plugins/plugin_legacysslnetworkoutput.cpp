@@ -28,7 +28,12 @@ PluginLegacySSLNetworkOutput::PluginLegacySSLNetworkOutput(
     VisionPlugin(_fb),
     _camera_params(camera_params),
     _field(field),
-    _ds_udp_server_old(ds_udp_server_old) {}
+    _ds_udp_server_old(ds_udp_server_old),
+    slot_detection_frame("ssl_detection_frame") {
+  //the time stamps and the camera id are filled in before sending
+  declareWrite(slot_detection_frame);
+  declareRead("camera_parameters");
+}
 
 PluginLegacySSLNetworkOutput::~PluginLegacySSLNetworkOutput() {}
 
@@ -71,7 +76,7 @@ ProcessResult PluginLegacySSLNetworkOutput::process(
 
   SSL_DetectionFrame * detection_frame;
 
-  detection_frame=(SSL_DetectionFrame *)data->map.get("ssl_detection_frame");
+  detection_frame=slot_detection_frame.get(data->map);
   if (detection_frame != nullptr) {
     detection_frame->set_t_capture(data->time);
     if (data->time_cam > 0) {
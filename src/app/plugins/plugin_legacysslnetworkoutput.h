@@ -35,6 +35,7 @@ protected:
  const RoboCupField& _field;
  // UDP Server for Double-Sized field, old protobuf format.
  RoboCupSSLServer * _ds_udp_server_old;
+ FrameDataSlot<SSL_DetectionFrame> slot_detection_frame;
 
 public:
   PluginLegacySSLNetworkOutput(FrameBuffer * _fb,
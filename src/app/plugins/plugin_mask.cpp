@@ -4,14 +4,25 @@
 
 PluginMask::PluginMask(FrameBuffer *buffer, ConvexHullImageMask &mask)
     : VisionPlugin(buffer), _mask(mask) {
+  declareRead("frame_video");
+  declareWrite("image_mask");
 
   _settings = new VarList("Image Mask");
-  _widget = new MaskWidget();
+  _widget = nullptr;
 }
 
 PluginMask::~PluginMask() { delete _settings; }
 
-QWidget *PluginMask::getControlWidget() { return (QWidget *)_widget; }
+QWidget *PluginMask::getControlWidget() {
+#ifdef VISION_HEADLESS
+  return nullptr;
+#else
+  if (_widget == nullptr) {
+    _widget = new MaskWidget();
+  }
+  return (QWidget *)_widget;
+#endif
+}
 
 VarList *PluginMask::getSettings() { return _settings; }
 
@@ -24,10 +35,12 @@ ProcessResult PluginMask::process(FrameData *data, RenderOptions *options) {
   if (_mask.getNumPixels() != data->video.getNumPixels())
     _mask.setSize(data->video.getWidth(), data->video.getHeight());
 
-  if (_widget->clear_mask_button->isChecked()) {
+#ifndef VISION_HEADLESS
+  if (_widget != nullptr && _widget->clear_mask_button->isChecked()) {
     _mask.reset();
     _widget->clear_mask_button->setChecked(false);
   }
+#endif
 
   return ProcessingOk;
 }
@@ -39,6 +52,14 @@ void PluginMask::_removePoint(const int x, const int y) {
 }
 
 void PluginMask::_mouseEvent(QMouseEvent *event, const pixelloc loc) {
+#ifdef VISION_HEADLESS
+  (void)loc;
+  event->ignore();
+#else
+  if (_widget == nullptr) {
+    event->ignore();
+    return;
+  }
   auto tabw = (QTabWidget*) _widget->parentWidget()->parentWidget();
   if (tabw->currentWidget() != _widget) {
     event->ignore();
@@ -80,6 +101,7 @@ void PluginMask::_mouseEvent(QMouseEvent *event, const pixelloc loc) {
 
     fb->unlockRead();
   }
+#endif
 }
 
 void PluginMask::mousePressEvent(QMouseEvent *event, pixelloc loc) {
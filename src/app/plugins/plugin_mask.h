@@ -3,15 +3,19 @@
 #include "colors.h"
 #include "convex_hull_image_mask.h"
 #include "framedata.h"
-#include "glLUTwidget.h"
 #include "gvector.h"
 #include "image.h"
+#ifndef VISION_HEADLESS
+#include "glLUTwidget.h"
 #include "lutwidget.h"
 #include "maskwidget.h"
+#endif
 #include "visionplugin.h"
 #include <algorithm>
 #include <vector>
 
+class MaskWidget;
+
 class PluginMask : public VisionPlugin {
 protected:
   MaskWidget *_widget;
@@ -23,6 +23,8 @@
 PluginPublishGeometry::PluginPublishGeometry(FrameBuffer * fb, RoboCupSSLServer * server, const RoboCupField & field)
  : VisionPlugin(fb), _field(field)
 {
+  //the geometry includes the calibration of the cameras
+  declareRead("camera_parameters");
   _server=server;
   setSharedAmongStacks(true);
   _settings=new VarList("Publish Geometry");
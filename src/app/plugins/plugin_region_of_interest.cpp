@@ -0,0 +1,261 @@
+//========================================================================
+//  This software is free: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License Version 3,
+//  as published by the Free Software Foundation.
+//
+//  This software is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  Version 3 in the file COPYING that came with this distribution.
+//  If not, see <http://www.gnu.org/licenses/>.
+//========================================================================
+/*!
+  \file    plugin_region_of_interest.cpp
+  \brief   C++ Implementation: PluginRegionOfInterest, PluginRegionOfInterestUpdate
+*/
+//========================================================================
+#include "plugin_region_of_interest.h"
+#include <algorithm>
+
+//the capacity of the coarse pass, which sees a quarter of the pixels
+static const int CoarseMaxRuns = 50000;
+static const int CoarseMaxRegions = 10000;
+
+static const char * const ModeNames[] = { "off", "last detections", "coarse pass" };
+
+PluginRegionOfInterest::PluginRegionOfInterest(FrameBuffer * _buffer, YUVLUT * _lut, ConvexHullImageMask & _image_mask)
+  : VisionPlugin(_buffer), lut(_lut), image_mask(_image_mask),
+    snapshot([this](Settings & s) {
+      s.mode=ModeOff;
+      for (int i=0;i<3;i++) {
+        if (v_mode->getString() == ModeNames[i]) s.mode=(Mode)i;
+      }
+      s.robot_margin=v_robot_margin->getInt();
+      s.ball_margin=v_ball_margin->getInt();
+      s.sweep_bands=v_sweep_bands->getInt();
+      s.coarse_margin=v_coarse_margin->getInt();
+      s.coarse_min_area=v_coarse_min_area->getInt();
+      s.validate_frames=v_validate_frames->getInt();
+      s.validate_tolerance=v_validate_tolerance->getInt();
+    }),
+    slot_roi("roi_spans"), windows_valid(false), sweep_band(0), validate_countdown(0),
+    validated_objects(0), missed_objects(0),
+    coarse_runs(CoarseMaxRuns), coarse_regions(CoarseMaxRegions)
+{
+  declareRead("frame_video");
+  declareRead("image_mask");
+  declareRead("lut");
+  declareWrite(slot_roi);
+
+  settings=new VarList("Region of Interest");
+  settings->addChild(v_mode = new VarStringEnum("mode", ModeNames[ModeOff]));
+  for (const char * name : ModeNames) {
+    v_mode->addItem(name);
+  }
+  //half the size of the windows around the last detections, in pixels
+  settings->addChild(v_robot_margin = new VarInt("robot margin (px)", 120, 1, 2000));
+  settings->addChild(v_ball_margin = new VarInt("ball margin (px)", 120, 1, 2000));
+  //the whole image is processed once every this many frames, one band per frame
+  settings->addChild(v_sweep_bands = new VarInt("full frame sweep (frames)", 10, 1, 1000));
+  //the full resolution pixels around the blobs of the coarse pass which are processed as well
+  settings->addChild(v_coarse_margin = new VarInt("coarse margin (px)", 4, 0, 1000));
+  settings->addChild(v_coarse_min_area = new VarInt("coarse min blob area", 1, 1, 10000));
+  //0: never
+  settings->addChild(v_validate_frames = new VarInt("coarse validation (frames)", 0, 0, 100000));
+  //the distance between the centroids of a detection and its blob in the coarse pass
+  settings->addChild(v_validate_tolerance = new VarInt("validation tolerance (px)", 2, 0, 100));
+  settings->addChild(v_validated_objects = new VarInt("validated objects", 0));
+  v_validated_objects->addFlags(VARTYPE_FLAG_READONLY | VARTYPE_FLAG_NOSTORE);
+  settings->addChild(v_missed_objects = new VarInt("objects missed by coarse pass", 0));
+  v_missed_objects->addFlags(VARTYPE_FLAG_READONLY | VARTYPE_FLAG_NOSTORE);
+  snapshot.watch(settings);
+}
+
+PluginRegionOfInterest::~PluginRegionOfInterest()
+{
+  delete settings;
+}
+
+bool PluginRegionOfInterest::isRestricting() const {
+  return snapshot.get()->mode != ModeOff;
+}
+
+void PluginRegionOfInterest::addWindow(vector<Window> & list, float x, float y, int margin) {
+  Window w;
+  w.x0=(int)x - margin;
+  w.y0=(int)y - margin;
+  w.x1=(int)x + margin + 1;
+  w.y1=(int)y + margin + 1;
+  list.push_back(w);
+}
+
+bool PluginRegionOfInterest::hasCentroidNear(const vector<vector2f> & centroids, float x, float y, int tolerance) {
+  float max_sq=(float)tolerance*tolerance;
+  for (const vector2f & c : centroids) {
+    float dx=c.x - x;
+    float dy=c.y - y;
+    if (dx*dx + dy*dy <= max_sq) return true;
+  }
+  return false;
+}
+
+void PluginRegionOfInterest::recordDetections(const SSL_DetectionFrame & frame, const RegionOfInterestSpans * roi) {
+  Settings s=*snapshot.get();
+  if (roi != nullptr && roi->validate) {
+    const vector<vector2f> & centroids=roi->coarse_centroids;
+    int missed=0;
+    for (const SSL_DetectionRobot & robot : frame.robots_blue()) {
+      if (!hasCentroidNear(centroids, robot.pixel_x(), robot.pixel_y(), s.validate_tolerance)) missed++;
+    }
+    for (const SSL_DetectionRobot & robot : frame.robots_yellow()) {
+      if (!hasCentroidNear(centroids, robot.pixel_x(), robot.pixel_y(), s.validate_tolerance)) missed++;
+    }
+    for (const SSL_DetectionBall & ball : frame.balls()) {
+      if (!hasCentroidNear(centroids, ball.pixel_x(), ball.pixel_y(), s.validate_tolerance)) missed++;
+    }
+    validated_objects+=frame.robots_blue_size() + frame.robots_yellow_size() + frame.balls_size();
+    missed_objects+=missed;
+  }
+  if (s.mode != ModeLastDetections) return;
+
+  vector<Window> list;
+  for (const SSL_DetectionRobot & robot : frame.robots_blue()) {
+    addWindow(list, robot.pixel_x(), robot.pixel_y(), s.robot_margin);
+  }
+  for (const SSL_DetectionRobot & robot : frame.robots_yellow()) {
+    addWindow(list, robot.pixel_x(), robot.pixel_y(), s.robot_margin);
+  }
+  for (const SSL_DetectionBall & ball : frame.balls()) {
+    addWindow(list, ball.pixel_x(), ball.pixel_y(), s.ball_margin);
+  }
+  const std::lock_guard<std::mutex> lock(windows_mutex);
+  windows.swap(list);
+  windows_valid=true;
+}
+
+bool PluginRegionOfInterest::findCoarseWindows(FrameData * data, const MaskSpans & mask_spans, const Settings & s,
+                                               vector<Window> & list, vector<vector2f> & centroids) {
+  if (!CMVisionThreshold::thresholdDecimated(&coarse_image, &data->video, lut, &image_mask.getMask(), &mask_spans)) {
+    return false;
+  }
+  CMVision::RegionProcessing::encodeRuns(&coarse_image, &coarse_runs);
+  if (coarse_runs.getUsedRuns() == coarse_runs.getMaxRuns()) return false;
+  CMVision::RegionProcessing::connectComponents(&coarse_runs);
+  CMVision::RegionProcessing::extractRegions(&coarse_regions, &coarse_runs);
+  if (coarse_regions.getUsedRegions() == coarse_regions.getMaxRegions()) return false;
+
+  const CMVision::Region * regions=coarse_regions.getRegionArrayPointer();
+  for (int i=0;i<coarse_regions.getUsedRegions();i++) {
+    const CMVision::Region & r=regions[i];
+    if (r.area < s.coarse_min_area) continue;
+    //coarse pixel x covers the full resolution pixels 2x and 2x+1
+    Window w;
+    w.x0=2*r.x1 - s.coarse_margin;
+    w.y0=2*r.y1 - s.coarse_margin;
+    w.x1=2*(r.x2 + 1) + s.coarse_margin;
+    w.y1=2*(r.y2 + 1) + s.coarse_margin;
+    list.push_back(w);
+    //coarse pixel x is sampled at full resolution pixel 2x
+    centroids.push_back(vector2f(2*r.cen_x, 2*r.cen_y));
+  }
+  return true;
+}
+
+ProcessResult PluginRegionOfInterest::process(FrameData * data, RenderOptions * options) {
+  (void)options;
+  Settings s=*snapshot.get();
+  RegionOfInterestSpans * roi=slot_roi.getOrCreate(data->map);
+  roi->active=false;
+  roi->validate=false;
+  roi->coarse_centroids.clear();
+
+  const std::lock_guard<std::mutex> lock(windows_mutex);
+  if (s.mode != ModeLastDetections) {
+    //start over with the full image when switched back
+    windows_valid=false;
+  }
+  if (s.mode == ModeOff) return ProcessingOk;
+  if (s.mode == ModeLastDetections && !windows_valid) return ProcessingOk;
+
+  int height=data->video.getHeight();
+  image_mask.lock();
+  const MaskSpans & mask_spans=image_mask.getSpans();
+  vector<Window> coarse_windows;
+  //the full image is processed if the coarse pass fails, e.g. because of too many blobs
+  bool ok=((int)mask_spans.size() == height);
+  if (ok && s.mode == ModeCoarsePass) ok=findCoarseWindows(data, mask_spans, s, coarse_windows, roi->coarse_centroids);
+  if (ok) {
+    //the rows keep their capacity from the last frame in this slot
+    roi->spans.resize(height);
+    for (RowSpans & row : roi->spans) {
+      row.clear();
+    }
+
+    if (s.mode == ModeLastDetections) {
+      sweep_band=(sweep_band + 1) % s.sweep_bands;
+      for (int y=sweep_band*height/s.sweep_bands; y<(sweep_band + 1)*height/s.sweep_bands; y++) {
+        roi->spans[y]=mask_spans[y];
+      }
+    }
+
+    //windows side by side keep the pixels in between out
+    for (const Window & w : (s.mode == ModeCoarsePass) ? coarse_windows : windows) {
+      for (int y=std::max(0, w.y0); y<std::min(height, w.y1); y++) {
+        for (const MaskSpan & span : mask_spans[y]) {
+          addSpan(roi->spans[y], std::max(w.x0, span.begin), std::min(w.x1, span.end));
+        }
+      }
+    }
+
+    //validation frames are processed completely, their detections are matched with the coarse blobs
+    if (s.mode == ModeCoarsePass && s.validate_frames > 0 && --validate_countdown <= 0) {
+      validate_countdown=s.validate_frames;
+      roi->validate=true;
+    } else {
+      roi->active=true;
+    }
+  }
+  image_mask.unlock();
+  return ProcessingOk;
+}
+
+void PluginRegionOfInterest::publishStatistics() {
+  v_validated_objects->setInt(validated_objects);
+  v_missed_objects->setInt(missed_objects);
+}
+
+VarList * PluginRegionOfInterest::getSettings() {
+  return settings;
+}
+
+string PluginRegionOfInterest::getName() {
+  return "Region of Interest";
+}
+
+
+
+PluginRegionOfInterestUpdate::PluginRegionOfInterestUpdate(FrameBuffer * _buffer, PluginRegionOfInterest * _roi)
+  : VisionPlugin(_buffer), roi(_roi), slot_detection_frame("ssl_detection_frame"), slot_roi("roi_spans")
+{
+  declareRead(slot_detection_frame);
+  declareRead(slot_roi);
+}
+
+bool PluginRegionOfInterestUpdate::isActive() const {
+  return roi->isRestricting();
+}
+
+ProcessResult PluginRegionOfInterestUpdate::process(FrameData * data, RenderOptions * options) {
+  (void)options;
+  SSL_DetectionFrame * frame=slot_detection_frame.get(data->map);
+  if (frame == nullptr) return ProcessingFailed;
+  roi->recordDetections(*frame, slot_roi.get(data->map));
+  return ProcessingOk;
+}
+
+string PluginRegionOfInterestUpdate::getName() {
+  return "Region of Interest Update";
+}
@@ -0,0 +1,180 @@
+//========================================================================
+//  This software is free: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License Version 3,
+//  as published by the Free Software Foundation.
+//
+//  This software is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  Version 3 in the file COPYING that came with this distribution.
+//  If not, see <http://www.gnu.org/licenses/>.
+//========================================================================
+/*!
+  \file    plugin_region_of_interest.h
+  \brief   C++ Interface: PluginRegionOfInterest, PluginRegionOfInterestUpdate
+*/
+//========================================================================
+#ifndef PLUGIN_REGION_OF_INTEREST_H
+#define PLUGIN_REGION_OF_INTEREST_H
+
+#include <visionplugin.h>
+#include <atomic>
+#include <mutex>
+#include "convex_hull_image_mask.h"
+#include "cmvision_region.h"
+#include "lut3d.h"
+#include "mask_spans.h"
+#include "settings_snapshot.h"
+#include "messages_robocup_ssl_detection.pb.h"
+
+/// the pixels of a frame which are processed, stored in the "roi_spans" slot
+struct RegionOfInterestSpans {
+  /// false while the whole image mask is processed, the spans are not used then
+  bool active;
+  /// the frame is processed completely to check that its detections lie within the spans
+  bool validate;
+  /// the spans of each row, within the spans of the image mask
+  MaskSpans spans;
+  /// the centroids of the blobs of the coarse pass, in full resolution pixels
+  vector<vector2f> coarse_centroids;
+  RegionOfInterestSpans() : active(false), validate(false) {}
+};
+
+/*!
+  \class   PluginRegionOfInterest
+  \brief   Restricts processing to windows which may contain objects
+
+  Thresholding and run length encoding then only look at these windows,
+  so that the empty parts of the field are skipped. The windows come from
+  one of two modes:
+
+  "last detections": square windows around the robots and balls detected
+  most recently. Additionally, one of a number of horizontal bands of the
+  image is processed completely in every frame, rotating through the bands,
+  so that new (or lost) objects are found within that many frames. The
+  detections are passed back by a PluginRegionOfInterestUpdate that follows
+  the detection plugins. Until it recorded a frame, the whole image is
+  processed.
+
+  "coarse pass": the frame is first thresholded at half the resolution in
+  both directions and its blobs are extracted. The windows are their
+  bounding boxes, grown by the coarse margin, in which the blobs are found
+  again at full resolution, with exact centroids and areas. Blobs which do
+  not show at half the resolution (thinner than two pixels) are lost. To
+  check this, every n-th frame can be processed completely, and detections
+  without a coarse blob within the validation tolerance are counted.
+
+  The region of interest is stored as the spans of each row, one per window
+  crossing the row unless windows overlap. PluginColorThreshold and
+  PluginRunlengthEncode use it in place of the spans of the image mask, so
+  PluginFindBlobs only sees runs inside of it.
+*/
+class PluginRegionOfInterest : public VisionPlugin
+{
+protected:
+  /// the pixels [x0, x1) x [y0, y1)
+  struct Window {
+    int x0;
+    int y0;
+    int x1;
+    int y1;
+  };
+  enum Mode {
+    ModeOff,
+    ModeLastDetections,
+    ModeCoarsePass
+  };
+  YUVLUT * lut;
+  ConvexHullImageMask & image_mask;
+  VarList * settings;
+  VarStringEnum * v_mode;
+  VarInt * v_robot_margin;
+  VarInt * v_ball_margin;
+  VarInt * v_sweep_bands;
+  VarInt * v_coarse_margin;
+  VarInt * v_coarse_min_area;
+  VarInt * v_validate_frames;
+  VarInt * v_validate_tolerance;
+  VarInt * v_validated_objects;
+  VarInt * v_missed_objects;
+  struct Settings {
+    Mode mode;
+    int robot_margin;
+    int ball_margin;
+    int sweep_bands;
+    int coarse_margin;
+    int coarse_min_area;
+    int validate_frames;
+    int validate_tolerance;
+  };
+  SettingsSnapshot<Settings> snapshot;
+  FrameDataSlot<RegionOfInterestSpans> slot_roi;
+
+  std::mutex windows_mutex;
+  vector<Window> windows;
+  bool windows_valid;
+  int sweep_band;
+  int validate_countdown;
+  //counted on the processing threads, see publishStatistics()
+  std::atomic<int> validated_objects;
+  std::atomic<int> missed_objects;
+
+  //scratch data of the coarse pass
+  Image<raw8> coarse_image;
+  CMVision::RunList coarse_runs;
+  CMVision::RegionList coarse_regions;
+
+  static void addWindow(vector<Window> & list, float x, float y, int margin);
+  /// the windows around the blobs found at half the resolution
+  bool findCoarseWindows(FrameData * data, const MaskSpans & mask_spans, const Settings & s,
+                         vector<Window> & list, vector<vector2f> & centroids);
+  /// whether one of \p centroids lies within \p tolerance pixels of (\p x, \p y)
+  static bool hasCentroidNear(const vector<vector2f> & centroids, float x, float y, int tolerance);
+
+public:
+  PluginRegionOfInterest(FrameBuffer * _buffer, YUVLUT * _lut, ConvexHullImageMask & _image_mask);
+
+  ~PluginRegionOfInterest() override;
+
+  /// whether frames are restricted to the region of interest
+  bool isRestricting() const;
+
+  /// passes the objects detected in a frame with region of interest \p roi:
+  /// in "last detections" mode, they replace the windows. On validation frames
+  /// of the coarse pass, detections are matched with the coarse blobs.
+  void recordDetections(const SSL_DetectionFrame & frame, const RegionOfInterestSpans * roi);
+
+  ProcessResult process(FrameData * data, RenderOptions * options) override;
+
+  void publishStatistics() override;
+
+  VarList * getSettings() override;
+
+  string getName() override;
+};
+
+/*!
+  \class   PluginRegionOfInterestUpdate
+  \brief   Passes the detections of each frame to a PluginRegionOfInterest
+*/
+class PluginRegionOfInterestUpdate : public VisionPlugin
+{
+protected:
+  PluginRegionOfInterest * roi;
+  FrameDataSlot<SSL_DetectionFrame> slot_detection_frame;
+  FrameDataSlot<RegionOfInterestSpans> slot_roi;
+
+public:
+  PluginRegionOfInterestUpdate(FrameBuffer * _buffer, PluginRegionOfInterest * _roi);
+
+  bool isActive() const override;
+
+  ProcessResult process(FrameData * data, RenderOptions * options) override;
+
+  string getName() override;
+};
+
+#endif
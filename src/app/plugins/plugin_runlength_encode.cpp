@@ -19,13 +19,39 @@
 */
 //========================================================================
 #include "plugin_runlength_encode.h"
+#include "task_pool.h"
+#include <algorithm>
+#include <atomic>
 
-PluginRunlengthEncode::PluginRunlengthEncode(FrameBuffer * _buffer)
- : VisionPlugin(_buffer)
+//size of the row tiles thresholded in fused mode, small enough to stay in the L2 cache
+static const int FusedTileBytes = 64*1024;
+
+PluginRunlengthEncode::PluginRunlengthEncode(FrameBuffer * _buffer, YUVLUT * _lut, ConvexHullImageMask * _image_mask)
+ : VisionPlugin(_buffer), lut(_lut), image_mask(_image_mask), v_fused(nullptr),
+   snapshot([this](Settings & s) {
+     s.max_runs=v_max_runs->getInt();
+     s.fused=(v_fused != nullptr && v_fused->getBool());
+   }),
+   slot_runlist("cmv_runlist"), slot_threshold("cmv_threshold"), slot_scratch("cmv_fused_scratch"),
+   slot_roi("roi_spans")
 {
+  declareRead(slot_threshold);
+  declareRead(slot_roi);
+  declareWrite(slot_runlist);
   settings=new VarList("Run length encode");
   v_max_runs = new VarInt("max runs", 50000, 10000, 1000000);
   settings->addChild(v_max_runs);
+  if (lut != nullptr && image_mask != nullptr) {
+    declareRead("frame_video");
+    declareRead("image_mask");
+    declareRead("lut");
+    declareWrite(slot_threshold);
+    declareWrite(slot_scratch);
+    //threshold and encode in one pass, see processFused()
+    v_fused = new VarBool("fused thresholding", false);
+    settings->addChild(v_fused);
+  }
+  snapshot.watch(settings);
 }
 
 
@@ -33,27 +59,144 @@ PluginRunlengthEncode::~PluginRunlengthEncode()
 {
   delete settings;
   delete v_max_runs;
+  delete v_fused;
 }
 
+void PluginRunlengthEncode::addThresholdImageConsumer(const std::function<bool()> & consumer) {
+  threshold_image_consumers.push_back(consumer);
+}
 
+void PluginRunlengthEncode::setThreadCount(const std::function<int()> & count) {
+  thread_count=count;
+}
 
-ProcessResult PluginRunlengthEncode::process(FrameData * data, RenderOptions * options) {
-  (void)options;
+bool PluginRunlengthEncode::isFused() const {
+  return snapshot.get()->fused;
+}
 
-  CMVision::RunList * runlist = (CMVision::RunList *) data->map.get("cmv_runlist");
-  if (runlist == nullptr || runlist->getMaxRuns() != v_max_runs->get()) {
-    delete runlist;
-    runlist = (CMVision::RunList *) data->map.update("cmv_runlist", new CMVision::RunList(v_max_runs->getInt()));
+bool PluginRunlengthEncode::isThresholdImageConsumed() const {
+  for (const auto & consumer : threshold_image_consumers) {
+    if (consumer()) return true;
   }
+  return false;
+}
 
-  Image<raw8> * img_thresholded = (Image<raw8> *) data->map.get("cmv_threshold");
-  if (img_thresholded == nullptr) {
-    printf("Runlength encoder: no thresholded input image found!\n");
+ProcessResult PluginRunlengthEncode::processFused(FrameData * data, CMVision::RunList * runlist,
+                                                  const RegionOfInterestSpans * roi) {
+  int width=data->video.getWidth();
+  int height=data->video.getHeight();
+  int tile_rows=std::max(1, FusedTileBytes / std::max(1, width));
+  int tiles=(height + tile_rows - 1) / tile_rows;
+  int threads=thread_count ? std::max(1, std::min(thread_count(), tiles)) : 1;
+  int max_runs=runlist->getMaxRuns();
+
+  //rows are thresholded straight into the full image if it is needed,
+  //otherwise into a tile per thread that is overwritten by its next rows
+  bool into_image=isThresholdImageConsumed();
+  //the detection plugins expect the image to exist. They only read it while it
+  //is consumed, an empty one keeps the visualization from showing stale labels.
+  Image<raw8> * img_thresholded = slot_threshold.getOrCreate(data->map);
+  FusedScratch * scratch = slot_scratch.getOrCreate(data->map);
+  if (into_image) {
+    img_thresholded->allocate(width, height);
+  } else {
+    img_thresholded->clear();
+    scratch->tiles.allocate(width, tile_rows * threads);
+  }
+  if (threads > 1) {
+    //a thread's run list holds all runs, so that a full one still gives the first max_runs runs
+    scratch->runs.resize(threads);
+    for (std::unique_ptr<CMVision::RunList> & runs : scratch->runs) {
+      if (!runs || runs->getMaxRuns() != max_runs) runs.reset(new CMVision::RunList(max_runs));
+    }
+    scratch->tile_runs.resize(tiles);
+  }
+
+  image_mask->lock();
+  const MaskSpans & spans=(roi != nullptr) ? roi->spans : image_mask->getSpans();
+  vector<int> used_runs(threads, 0);
+  std::atomic<bool> ok(true);
+  TaskPool::getInstance().claimRanges(threads, height, tile_rows, [&](int thread, int first, int last) {
+    CMVision::RunList * runs=(threads > 1) ? scratch->runs[thread].get() : runlist;
+    for (int y=first; y<last && ok; y+=tile_rows) {
+      int rows=std::min(tile_rows, last - y);
+      raw8 * rows_target=into_image ? img_thresholded->getPixelData() + y*width
+                                    : scratch->tiles.getPixelData() + thread*tile_rows*width;
+      if (!CMVisionThreshold::thresholdRows(rows_target, &data->video, lut, &image_mask->getMask(), y, y + rows, &spans)) {
+        ok=false;
+        return;
+      }
+      int before=used_runs[thread];
+      used_runs[thread]=CMVision::RegionProcessing::encodeRows(rows_target, width, y, rows, runs, before, &spans);
+      if (threads > 1) {
+        FusedScratch::TileRuns & tile=scratch->tile_runs[y / tile_rows];
+        tile.thread=thread;
+        tile.first=before;
+        tile.count=used_runs[thread] - before;
+      }
+    }
+  });
+  image_mask->unlock();
+  if (!ok) {
+    runlist->setUsedRuns(0);
     return ProcessingFailed;
   }
+  if (threads <= 1) {
+    runlist->setUsedRuns(used_runs[0]);
+    return ProcessingOk;
+  }
 
-  //Runlength Encode the image:
-  CMVision::RegionProcessing::encodeRuns(img_thresholded, runlist);
+  //the runs of the tiles are joined in row order, each run starts as its own parent
+  CMVision::Run * target=runlist->getRunArrayPointer();
+  int n=0;
+  for (const FusedScratch::TileRuns & tile : scratch->tile_runs) {
+    const CMVision::Run * source=scratch->runs[tile.thread]->getRunArrayPointer() + tile.first;
+    int count=std::min(tile.count, max_runs - n);
+    for (int i=0;i<count;i++, n++) {
+      target[n]=source[i];
+      target[n].parent=n;
+    }
+    if (n == max_runs) break;
+  }
+  runlist->setUsedRuns(n);
+  return ProcessingOk;
+}
+
+
+
+ProcessResult PluginRunlengthEncode::process(FrameData * data, RenderOptions * options) {
+  (void)options;
+
+  Settings s=*snapshot.get();
+  CMVision::RunList * runlist = slot_runlist.get(data->map);
+  if (runlist == nullptr || runlist->getMaxRuns() != s.max_runs) {
+    runlist = slot_runlist.update(data->map, new CMVision::RunList(s.max_runs));
+  }
+
+  //only the region of interest is encoded if there is one
+  const RegionOfInterestSpans * roi = slot_roi.get(data->map);
+  if (roi != nullptr && !roi->active) roi=nullptr;
+
+  if (s.fused) {
+    if (processFused(data, runlist, roi) != ProcessingOk) return ProcessingFailed;
+  } else {
+    Image<raw8> * img_thresholded = slot_threshold.get(data->map);
+    if (img_thresholded == nullptr) {
+      printf("Runlength encoder: no thresholded input image found!\n");
+      return ProcessingFailed;
+    }
+
+    //Runlength Encode the image, the pixels outside of the region of interest or image mask are known to be clear:
+    if (roi != nullptr) {
+      CMVision::RegionProcessing::encodeRuns(img_thresholded, runlist, &roi->spans);
+    } else if (image_mask != nullptr) {
+      image_mask->lock();
+      CMVision::RegionProcessing::encodeRuns(img_thresholded, runlist, &image_mask->getSpans());
+      image_mask->unlock();
+    } else {
+      CMVision::RegionProcessing::encodeRuns(img_thresholded, runlist);
+    }
+  }
   if (runlist->getUsedRuns() == runlist->getMaxRuns()) {
     printf("Warning: runlength encoder exceeded current max run size of %d\n",runlist->getMaxRuns());
   }
@@ -69,3 +212,7 @@ VarList * PluginRunlengthEncode::getSettings() {
 string PluginRunlengthEncode::getName() {
   return "RunlengthEncode";
 }
+
+bool PluginRunlengthEncode::isFrameParallel() const {
+  return true;
+}
@@ -22,24 +22,82 @@
 #define PLUGIN_RUNLENGTHENCODE_H
 
 #include <visionplugin.h>
+#include <functional>
+#include <memory>
 #include "cmvision_region.h"
+#include "cmvision_threshold.h"
+#include "convex_hull_image_mask.h"
 #include "timer.h"
+#include "settings_snapshot.h"
+#include "plugin_region_of_interest.h"
 
 /**
 	@author Stefan Zickler
+
+  Given a LUT and image mask, the encoder can optionally fuse thresholding
+  and run length encoding: the video frame is thresholded in row tiles
+  that stay in the cache, and each tile is encoded right away. The full
+  thresholded image ("cmv_threshold") is then only written while one of
+  the registered consumers needs it, otherwise it is left empty.
+  PluginColorThreshold is skipped. With several threads, each one encodes
+  the tiles it claims into a run list of its own, and the runs of all
+  tiles are joined in row order afterwards.
 */
 class PluginRunlengthEncode : public VisionPlugin
 {
 protected:
+  YUVLUT * lut;
+  ConvexHullImageMask * image_mask;
   VarList * settings;
   VarInt * v_max_runs;
+  VarBool * v_fused;
+  struct Settings {
+    int max_runs;
+    bool fused;
+  };
+  SettingsSnapshot<Settings> snapshot;
+  vector<std::function<bool()> > threshold_image_consumers;
+  std::function<int()> thread_count;
+  /// the per frame scratch data of fused mode
+  struct FusedScratch {
+    /// the runs of a tile of rows, in the run list of the thread that encoded it
+    struct TileRuns {
+      int thread;
+      int first;
+      int count;
+    };
+    /// one tile of rows per thread, if the thresholded image is not needed
+    Image<raw8> tiles;
+    vector<std::unique_ptr<CMVision::RunList> > runs;
+    vector<TileRuns> tile_runs;
+  };
+  FrameDataSlot<CMVision::RunList> slot_runlist;
+  FrameDataSlot<Image<raw8> > slot_threshold;
+  FrameDataSlot<FusedScratch> slot_scratch;
+  FrameDataSlot<RegionOfInterestSpans> slot_roi;
+
+  bool isThresholdImageConsumed() const;
+  ProcessResult processFused(FrameData * data, CMVision::RunList * runlist, const RegionOfInterestSpans * roi);
 public:
-    explicit PluginRunlengthEncode(FrameBuffer * _buffer);
+    explicit PluginRunlengthEncode(FrameBuffer * _buffer, YUVLUT * _lut = nullptr, ConvexHullImageMask * _image_mask = nullptr);
 
     ~PluginRunlengthEncode() override;
 
+    /// registers a check whether somebody reads the thresholded image of the current frame.
+    /// Must be called before processing starts.
+    void addThresholdImageConsumer(const std::function<bool()> & consumer);
+
+    /// sets the number of threads thresholding and encoding a frame in fused mode.
+    /// Must be called before processing starts.
+    void setThreadCount(const std::function<int()> & count);
+
+    /// whether thresholding is done by this plugin (fused mode)
+    bool isFused() const;
+
     ProcessResult process(FrameData * data, RenderOptions * options) override;
 
+    bool isFrameParallel() const override;
+
     VarList * getSettings() override;
 
     string getName() override;
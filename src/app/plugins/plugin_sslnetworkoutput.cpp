@@ -20,10 +20,16 @@
 //========================================================================
 #include "plugin_sslnetworkoutput.h"
 
-PluginSSLNetworkOutput::PluginSSLNetworkOutput(FrameBuffer * _fb, RoboCupSSLServer * udp_server, const CameraParameters& camera_params, const RoboCupField& field)
- : VisionPlugin(_fb), _camera_params(camera_params), _field(field)
+PluginSSLNetworkOutput::PluginSSLNetworkOutput(FrameBuffer * _fb, RoboCupSSLServer * udp_server, const CameraParameters& camera_params, const RoboCupField& field,
+                                               DetectionAggregator * aggregator, int stack_index)
+ : VisionPlugin(_fb), _camera_params(camera_params), _field(field), slot_detection_frame("ssl_detection_frame")
 {
+  //the time stamps and the camera id are filled in before sending
+  declareWrite(slot_detection_frame);
+  declareRead("camera_parameters");
   _udp_server=udp_server;
+  _aggregator=aggregator;
+  _stack_index=stack_index;
 }
 
 PluginSSLNetworkOutput::~PluginSSLNetworkOutput()
@@ -39,7 +45,7 @@ ProcessResult PluginSSLNetworkOutput::process(FrameData * data, RenderOptions *
 
   SSL_DetectionFrame * detection_frame;
 
-  detection_frame=(SSL_DetectionFrame *)data->map.get("ssl_detection_frame");
+  detection_frame=slot_detection_frame.get(data->map);
   if (detection_frame != nullptr) {
     detection_frame->set_t_capture(data->time);
     if (data->time_cam > 0) {
@@ -49,8 +55,12 @@ ProcessResult PluginSSLNetworkOutput::process(FrameData * data, RenderOptions *
     }
     detection_frame->set_frame_number(data->number);
     detection_frame->set_camera_id(_camera_params.additional_calibration_information->camera_index->getInt());
-    detection_frame->set_t_sent(GetTimeSec());
-    _udp_server->send(*detection_frame);
+    if (_aggregator != nullptr && _aggregator->isEnabled()) {
+      _aggregator->submit(_stack_index, *detection_frame);
+    } else {
+      detection_frame->set_t_sent(GetTimeSec());
+      _udp_server->send(*detection_frame);
+    }
   }
   return ProcessingOk;
 }
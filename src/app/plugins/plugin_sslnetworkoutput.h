@@ -26,6 +26,7 @@
 #include "camera_calibration.h"
 #include "field.h"
 #include "timer.h"
+#include "detection_aggregator.h"
 
 /**
 	@author Stefan Zickler
@@ -36,8 +37,14 @@ protected:
  const CameraParameters& _camera_params;
  const RoboCupField& _field;
  RoboCupSSLServer * _udp_server;
+ DetectionAggregator * _aggregator;
+ int _stack_index;
+ FrameDataSlot<SSL_DetectionFrame> slot_detection_frame;
 public:
-    PluginSSLNetworkOutput(FrameBuffer * _fb, RoboCupSSLServer * udp_server, const CameraParameters& camera_params, const RoboCupField& field);
+    /// if an \p aggregator is given, detection frames are handed to it as
+    /// stack number \p stack_index instead of being sent directly, while it is enabled
+    PluginSSLNetworkOutput(FrameBuffer * _fb, RoboCupSSLServer * udp_server, const CameraParameters& camera_params, const RoboCupField& field,
+                           DetectionAggregator * aggregator = nullptr, int stack_index = 0);
 
     ~PluginSSLNetworkOutput();
 
@@ -19,7 +19,6 @@
 */
 //========================================================================
 #include "plugin_visualize.h"
-#include "plugin_camera_intrinsic_calib.h"
 #include <sobel.h>
 #include <opencv2/opencv.hpp>
 #include "convex_hull.h"
@@ -34,7 +33,23 @@ PluginVisualize::PluginVisualize(
     const RoboCupField& real_field, const ConvexHullImageMask& mask) :
     VisionPlugin(_buffer), camera_parameters(camera_params),
     real_field(real_field),
-    _image_mask(mask){
+    _image_mask(mask),
+    slot_vis_frame("vis_frame"),
+    slot_threshold("cmv_threshold"),
+    slot_colorlist("cmv_colorlist"),
+    slot_chessboard("chessboard"),
+    slot_chessboard_img_points("chessboard_img_points"),
+    slot_sobel_scratch("vis_sobel_scratch") {
+  declareRead("frame_video");
+  declareRead("image_mask");
+  declareRead("lut");
+  declareRead("camera_parameters");
+  declareRead(slot_threshold);
+  declareRead(slot_colorlist);
+  declareRead(slot_chessboard);
+  declareRead(slot_chessboard_img_points);
+  declareWrite(slot_vis_frame);
+  declareWrite(slot_sobel_scratch);
   _v_enabled = new VarBool("enable", true);
   _v_image = new VarBool("image", true);
   _v_greyscale = new VarBool("greyscale", false);
@@ -68,14 +83,14 @@ PluginVisualize::PluginVisualize(
   _settings->addChild(_v_mask_hull);
   _settings->addChild(_v_chessboard);
   _threshold_lut=0;
-  edge_image = 0;
-  temp_grey_image = 0;
 }
 
 
 PluginVisualize::~PluginVisualize() {
-  if (edge_image) delete edge_image;
-  if (temp_grey_image) delete temp_grey_image;
+}
+
+bool PluginVisualize::isFrameParallel() const {
+  return true;
 }
 
 VarList * PluginVisualize::getSettings() {
@@ -132,8 +147,7 @@ void PluginVisualize::DrawCameraImage(
 void PluginVisualize::DrawThresholdedImage(
     FrameData* data, VisualizationFrame* vis_frame) {
   if (_threshold_lut != 0) {
-    Image<raw8>* img_thresholded =
-        reinterpret_cast<Image<raw8>*>(data->map.get("cmv_threshold"));
+    Image<raw8>* img_thresholded = slot_threshold.get(data->map);
     if (img_thresholded != 0) {
       int n = vis_frame->data.getNumPixels();
       if (img_thresholded->getNumPixels() == n) {
@@ -152,9 +166,7 @@ void PluginVisualize::DrawThresholdedImage(
 
 void PluginVisualize::DrawBlobs(
     FrameData* data, VisualizationFrame* vis_frame) {
-  CMVision::ColorRegionList* colorlist =
-      reinterpret_cast<CMVision::ColorRegionList*>(
-          data->map.get("cmv_colorlist"));
+  CMVision::ColorRegionList* colorlist = slot_colorlist.get(data->map);
   if (colorlist != 0) {
     CMVision::RegionLinkedList * regionlist;
     regionlist = colorlist->getColorRegionArrayPointer();
@@ -282,12 +294,11 @@ void PluginVisualize::DrawCalibrationResult(
 
 void PluginVisualize::DrawSobelImage(
     FrameData* data, VisualizationFrame* vis_frame) {
-  if (edge_image == 0) {
-    edge_image =
-        new greyImage(data->video.getWidth(),data->video.getHeight());
-    temp_grey_image =
-        new greyImage(data->video.getWidth(),data->video.getHeight());
-  }
+  SobelScratch* scratch = slot_sobel_scratch.getOrCreate(data->map);
+  greyImage* edge_image = &scratch->edge_image;
+  greyImage* temp_grey_image = &scratch->temp_grey_image;
+  edge_image->allocate(data->video.getWidth(),data->video.getHeight());
+  temp_grey_image->allocate(data->video.getWidth(),data->video.getHeight());
   Images::convert(vis_frame->data, *temp_grey_image);
   // Draw sobel image: Contrast towards more brightness is painted white,
   //                   Contrast towards more darkness is painted green
@@ -450,16 +461,15 @@ void PluginVisualize::DrawMaskHull(
   _image_mask.unlock();
 }
 
+bool PluginVisualize::isActive() const {
+  return isDisplayed();
+}
+
 ProcessResult PluginVisualize::process(
     FrameData* data, RenderOptions* options) {
   if (data == 0) return ProcessingFailed;
 
-  VisualizationFrame* vis_frame =
-      reinterpret_cast<VisualizationFrame*>(data->map.get("vis_frame"));
-  if (vis_frame == 0) {
-    vis_frame = reinterpret_cast<VisualizationFrame*>(
-        data->map.insert("vis_frame",new VisualizationFrame()));
-  }
+  VisualizationFrame* vis_frame = slot_vis_frame.getOrCreate(data->map);
 
   if (_v_enabled->getBool()) {
     //check video data...
@@ -580,7 +590,7 @@ void PluginVisualize::drawFieldLine(
 void PluginVisualize::DrawChessboard(FrameData *data,
                                      VisualizationFrame *vis_frame) {
   Chessboard *chessboard;
-  if ((chessboard = reinterpret_cast<Chessboard*>(data->map.get("chessboard"))) == nullptr) {
+  if ((chessboard = slot_chessboard.get(data->map)) == nullptr) {
     std::cerr << "chessboard_found key missing from data map.\n";
     return;
   }
@@ -595,7 +605,7 @@ void PluginVisualize::DrawChessboard(FrameData *data,
 
 void PluginVisualize::DrawChessboardCalibrationPoints(FrameData *data, VisualizationFrame *vis_frame) {
   std::vector<std::vector<cv::Point2f>> *chessboard_img_points;
-  if ((chessboard_img_points = reinterpret_cast<std::vector<std::vector<cv::Point2f>> *>(data->map.get("chessboard_img_points"))) == nullptr) {
+  if ((chessboard_img_points = slot_chessboard_img_points.get(data->map)) == nullptr) {
     return;
   }
 
@@ -30,6 +30,7 @@
 #include "field.h"
 #include "plugin_mask.h"
 #include "convex_hull_image_mask.h"
+#include "plugin_camera_intrinsic_calib.h"
 
 /**
 	@author Stefan Zickler
@@ -51,6 +52,16 @@ class VisualizationFrame {
     }
 };
 
+/*!
+  \class   SobelScratch
+  \brief   Per-frame working images of the sobel visualization
+*/
+class SobelScratch {
+  public:
+  greyImage edge_image;
+  greyImage temp_grey_image;
+};
+
 class PluginVisualize : public VisionPlugin
 {
 protected:
@@ -75,8 +86,13 @@ protected:
   const ConvexHullImageMask& _image_mask;
 
   LUT3D * _threshold_lut;
-  greyImage* edge_image;
-  greyImage* temp_grey_image;
+
+  FrameDataSlot<VisualizationFrame> slot_vis_frame;
+  FrameDataSlot<Image<raw8> > slot_threshold;
+  FrameDataSlot<CMVision::ColorRegionList> slot_colorlist;
+  FrameDataSlot<Chessboard> slot_chessboard;
+  FrameDataSlot<std::vector<std::vector<cv::Point2f> > > slot_chessboard_img_points;
+  FrameDataSlot<SobelScratch> slot_sobel_scratch;
 
   void drawFieldArc(
       const GVector::vector3d<double>& center,
@@ -114,8 +130,8 @@ protected:
 
   void DrawMaskHull(FrameData* data, VisualizationFrame* vis_frame);
 
-  static void DrawChessboard(FrameData* data, VisualizationFrame* vis_frame);
-  static void DrawChessboardCalibrationPoints(FrameData* data, VisualizationFrame* vis_frame);
+  void DrawChessboard(FrameData* data, VisualizationFrame* vis_frame);
+  void DrawChessboardCalibrationPoints(FrameData* data, VisualizationFrame* vis_frame);
 public:
   PluginVisualize(FrameBuffer* _buffer, const CameraParameters& camera_params,
                   const RoboCupField& real_field, const ConvexHullImageMask &mask);
@@ -124,6 +140,9 @@ public:
 
    void setThresholdingLUT(LUT3D * threshold_lut);
    ProcessResult process(FrameData * data, RenderOptions * options) override;
+   /// the visualization frame is only drawn while somebody looks at it
+   bool isActive() const override;
+   bool isFrameParallel() const override;
    VarList * getSettings() override;
    string getName() override;
 };
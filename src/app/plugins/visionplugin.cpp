@@ -27,6 +27,8 @@ VisionPlugin::VisionPlugin(FrameBuffer * _buffer)
   enabled=true;
   shared=false;
   visualize=true;
+  access_declared=false;
+  displayed=false;
   setTimeProcessing(0.0);
   setTimePostProcessing(0.0);
 }
@@ -45,13 +47,70 @@ FrameBuffer * VisionPlugin::getFrameBuffer() const {
 }
 
 void VisionPlugin::lock() {
-  mutex.lock();
+  mutex.lockForWrite();
 }
 
 void VisionPlugin::unlock() {
   mutex.unlock();
 }
 
+void VisionPlugin::lockShared() {
+  mutex.lockForRead();
+}
+
+bool VisionPlugin::isFrameParallel() const {
+  return false;
+}
+
+void VisionPlugin::declareRead(int slot_id) {
+  access_declared=true;
+  reads.push_back(slot_id);
+}
+
+void VisionPlugin::declareWrite(int slot_id) {
+  access_declared=true;
+  writes.push_back(slot_id);
+}
+
+void VisionPlugin::declareRead(const string & resource) {
+  declareRead(FrameDataMap::registerSlot(resource));
+}
+
+void VisionPlugin::declareWrite(const string & resource) {
+  declareWrite(FrameDataMap::registerSlot(resource));
+}
+
+void VisionPlugin::declareNoFrameAccess() {
+  access_declared=true;
+}
+
+bool VisionPlugin::hasDeclaredAccess() const {
+  return access_declared;
+}
+
+const vector<int> & VisionPlugin::getReads() const {
+  return reads;
+}
+
+const vector<int> & VisionPlugin::getWrites() const {
+  return writes;
+}
+
+void VisionPlugin::publishStatistics() {
+}
+
+bool VisionPlugin::isActive() const {
+  return true;
+}
+
+void VisionPlugin::setDisplayed(bool enable) {
+  displayed=enable;
+}
+
+bool VisionPlugin::isDisplayed() const {
+  return displayed;
+}
+
 bool VisionPlugin::isEnabled() const {
   return enabled;
 }
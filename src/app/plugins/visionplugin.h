@@ -24,8 +24,10 @@
 #include <QMouseEvent>
 #include <QKeyEvent>
 #include <QMutex>
+#include <QReadWriteLock>
 #include <QObject>
 #include <string>
+#include <atomic>
 
 #include "VarTypes.h"
 #include "framedata.h"
@@ -51,13 +53,41 @@ enum ProcessResult {
 class VisionPlugin : public QObject {
 Q_OBJECT
 protected:
-    QMutex mutex;
+    QReadWriteLock mutex;
     bool enabled;
     bool visualize;
     bool shared;
     FrameBuffer * buffer;
     double time_proc;
     double time_post;
+
+    /// the FrameData slots read and written by process(). plugins without
+    /// declared access are treated as reading and writing everything.
+    bool access_declared;
+    vector<int> reads;
+    vector<int> writes;
+
+    std::atomic<bool> displayed;
+
+    /// these functions should be called in the constructor to declare which
+    /// FrameData slots process() reads and writes. The VisionStack uses this
+    /// to run independent plugins concurrently. Data which is not stored in
+    /// the FrameDataMap is declared by a resource name, e.g. "frame_video"
+    /// for FrameData::video. State shared by the plugins of a stack is
+    /// declared alike: "lut" for the color LUT, "camera_parameters" for
+    /// the camera calibration.
+    void declareRead(int slot_id);
+    void declareWrite(int slot_id);
+    void declareRead(const string & resource);
+    void declareWrite(const string & resource);
+    template <class T> void declareRead(const FrameDataSlot<T> & slot) {
+      declareRead(slot.getId());
+    }
+    template <class T> void declareWrite(const FrameDataSlot<T> & slot) {
+      declareWrite(slot.getId());
+    }
+    /// declares that process() does not access any data of the frame
+    void declareNoFrameAccess();
 public:
 
 
@@ -76,6 +106,31 @@ public:
     /// you should *NOT* need to touch them
     void lock();
     void unlock();
+    /// used instead of lock() while processing frame-parallel plugins,
+    /// so that several frames can be processed at the same time
+    void lockShared();
+
+    /// indicates whether process() may run concurrently on different frames.
+    /// such a plugin must not modify any of its members in process(), and has
+    /// to keep all of its per-frame scratch data in the FrameDataMap instead.
+    virtual bool isFrameParallel() const;
+
+    /// returns whether the FrameData access of process() was declared,
+    /// and the declared slots (see declareRead() / declareWrite())
+    bool hasDeclaredAccess() const;
+    const vector<int> & getReads() const;
+    const vector<int> & getWrites() const;
+
+    /// indicates whether somebody currently consumes the results of this plugin,
+    /// e.g. a visible widget, an enabled calibration or a running recording.
+    /// process() and postProcess() are skipped while this returns false.
+    /// It is called while the plugin is locked.
+    virtual bool isActive() const;
+
+    /// set by the VisionStack when its visualization is shown on or hidden from the screen.
+    /// plugins that only serve the user interface can be inactive while not displayed.
+    void setDisplayed(bool enable);
+    bool isDisplayed() const;
 
     /// indicates whether this plugin will be used
     /// (e.g. whether process() will be called on it)
@@ -98,6 +153,11 @@ public:
     /// which should occur with the same frequency as your camera input
     virtual void displayLoopEvent(bool frame_changed, RenderOptions * opts);
 
+    /// called periodically on the GUI thread (or the main thread of the headless
+    /// application) to copy statistics gathered by process() into read-only
+    /// settings, so that the processing threads do not touch the data tree.
+    virtual void publishStatistics();
+
     /// this is the main-processing function. It allows your plugin to operate on the
     /// current frame-data
     virtual ProcessResult process(FrameData * data, RenderOptions * options);
@@ -0,0 +1,177 @@
+//========================================================================
+//  This software is free: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License Version 3,
+//  as published by the Free Software Foundation.
+//
+//  This software is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  Version 3 in the file COPYING that came with this distribution.
+//  If not, see <http://www.gnu.org/licenses/>.
+//========================================================================
+/*!
+  \file    detection_aggregator.cpp
+  \brief   C++ Implementation: DetectionAggregator
+*/
+//========================================================================
+
+#include "detection_aggregator.h"
+#include <cmath>
+#include <algorithm>
+#include "timer.h"
+
+DetectionAggregator::DetectionAggregator(RoboCupSSLServer * udp_server, int num_cameras) {
+  _udp_server=udp_server;
+  _num_cameras=num_cameras;
+
+  settings=new VarList("Capture Synchronization");
+  // when disabled, every camera sends its frame as soon as it is processed
+  settings->addChild(_v_enabled = new VarBool("enable", false));
+  settings->addChild(_v_window = new VarDouble("t_capture window (ms)", 5.0, 0.0, 100.0));
+  settings->addChild(_v_deadline = new VarDouble("deadline (ms)", 10.0, 0.0, 100.0));
+  settings->addChild(_v_skew_list = new VarList("arrival skew (ms)"));
+  for (int i=0;i<num_cameras;i++) {
+    VarDouble * v=new VarDouble("camera " + std::to_string(i), 0.0);
+    v->addFlags(VARTYPE_FLAG_READONLY);
+    _v_skew_list->addChild(v);
+    _v_skew.push_back(v);
+  }
+
+  group.resize(num_cameras);
+  for (auto & e : group) {
+    e.present=false;
+  }
+  group_size=0;
+  group_t_capture=0.0;
+  group_first_arrival=0.0;
+  skew.assign(num_cameras, 0.0);
+
+  running=true;
+  deadline_thread=std::thread(&DetectionAggregator::runDeadlines, this);
+}
+
+DetectionAggregator::~DetectionAggregator() {
+  {
+    const std::lock_guard<std::mutex> lock(group_mutex);
+    running=false;
+  }
+  group_changed.notify_all();
+  if (deadline_thread.joinable()) deadline_thread.join();
+}
+
+VarList * DetectionAggregator::getSettings() {
+  return settings;
+}
+
+bool DetectionAggregator::isEnabled() const {
+  return _v_enabled->getBool();
+}
+
+void DetectionAggregator::setCameraActivity(const std::function<bool(int)> & active) {
+  const std::lock_guard<std::mutex> lock(group_mutex);
+  camera_active=active;
+}
+
+int DetectionAggregator::countActiveCameras() const {
+  if (!camera_active) return _num_cameras;
+  int n=0;
+  for (int i=0;i<_num_cameras;i++) {
+    if (camera_active(i)) n++;
+  }
+  return n;
+}
+
+double DetectionAggregator::now() {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void DetectionAggregator::submit(int camera, const SSL_DetectionFrame & frame) {
+  if (camera < 0 || camera >= _num_cameras) return;
+  double arrival=now();
+  std::vector<Outgoing> closed;
+  std::vector<Outgoing> completed;
+  std::unique_lock<std::mutex> send_lock(send_mutex, std::defer_lock);
+  std::unique_lock<std::mutex> lock(group_mutex);
+
+  //a frame of another capture instant, or a second frame of the same camera, closes the group
+  if (group_size > 0 &&
+      (group[camera].present || fabs(frame.t_capture() - group_t_capture) > _v_window->getDouble() / 1000.0)) {
+    takeGroupLocked(closed);
+  }
+
+  if (group_size == 0) {
+    group_t_capture=frame.t_capture();
+    group_first_arrival=arrival;
+    group_deadline=std::chrono::steady_clock::now()
+        + std::chrono::microseconds((long long)(_v_deadline->getDouble() * 1000.0));
+    group_changed.notify_all();
+  }
+  group[camera].frame.CopyFrom(frame);
+  group[camera].arrival=arrival;
+  group[camera].present=true;
+  group_size++;
+
+  //the submitting camera is counted even if it just stopped capturing
+  if (group_size >= std::max(1, countActiveCameras())) {
+    takeGroupLocked(completed);
+  }
+  if (closed.empty() && completed.empty()) return;
+  send_lock.lock();
+  lock.unlock();
+  send(closed);
+  send(completed);
+}
+
+void DetectionAggregator::takeGroupLocked(std::vector<Outgoing> & ready) {
+  for (int i=0;i<_num_cameras;i++) {
+    Entry & e=group[i];
+    if (!e.present) continue;
+    skew[i]=0.9*skew[i] + 0.1*(e.arrival - group_first_arrival);
+    ready.emplace_back();
+    ready.back().camera=i;
+    ready.back().frame.Swap(&e.frame);
+    e.present=false;
+  }
+  group_size=0;
+}
+
+void DetectionAggregator::send(std::vector<Outgoing> & ready) {
+  double t_sent=GetTimeSec();
+  for (auto & o : ready) {
+    o.frame.set_t_sent(t_sent);
+    _udp_server->send(o.frame);
+  }
+}
+
+void DetectionAggregator::publishStatistics() {
+  std::vector<double> current;
+  {
+    const std::lock_guard<std::mutex> lock(group_mutex);
+    current=skew;
+  }
+  for (int i=0;i<_num_cameras;i++) {
+    _v_skew[i]->setDouble(current[i]*1000.0);
+  }
+}
+
+void DetectionAggregator::runDeadlines() {
+  std::unique_lock<std::mutex> lock(group_mutex);
+  while (running) {
+    if (group_size == 0) {
+      group_changed.wait(lock);
+    } else if (group_changed.wait_until(lock, group_deadline) == std::cv_status::timeout) {
+      if (group_size > 0 && std::chrono::steady_clock::now() >= group_deadline) {
+        std::vector<Outgoing> expired;
+        takeGroupLocked(expired);
+        std::unique_lock<std::mutex> send_lock(send_mutex);
+        lock.unlock();
+        send(expired);
+        send_lock.unlock();
+        lock.lock();
+      }
+    }
+  }
+}
@@ -0,0 +1,114 @@
+//========================================================================
+//  This software is free: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License Version 3,
+//  as published by the Free Software Foundation.
+//
+//  This software is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  Version 3 in the file COPYING that came with this distribution.
+//  If not, see <http://www.gnu.org/licenses/>.
+//========================================================================
+/*!
+  \file    detection_aggregator.h
+  \brief   C++ Interface: DetectionAggregator
+*/
+//========================================================================
+
+#ifndef DETECTION_AGGREGATOR_H
+#define DETECTION_AGGREGATOR_H
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <vector>
+#include <functional>
+#include "VarTypes.h"
+#include "messages_robocup_ssl_detection.pb.h"
+#include "robocup_ssl_server.h"
+
+using namespace VarTypes;
+
+/*!
+  \class   DetectionAggregator
+  \brief   Groups the detection frames of all cameras that belong to the same capture instant
+
+  Each camera stack submits its SSL_DetectionFrame instead of sending it right away.
+  Frames whose t_capture lies within a configurable window of the first frame of
+  the current group are collected. The group is sent back-to-back as soon as
+  every active camera reported, or when the deadline after the first arrival
+  expires. Cameras which are not capturing are not waited for.
+
+  For every camera, the arrival time relative to the first camera of the
+  group is tracked as a moving average (the arrival skew).
+*/
+class DetectionAggregator
+{
+protected:
+  struct Entry {
+    SSL_DetectionFrame frame;
+    double arrival;
+    bool present;
+  };
+  /// a frame of a closed group, which is sent outside of group_mutex
+  struct Outgoing {
+    int camera;
+    SSL_DetectionFrame frame;
+  };
+
+  RoboCupSSLServer * _udp_server;
+  int _num_cameras;
+
+  VarList * settings;
+  VarBool * _v_enabled;
+  VarDouble * _v_window;
+  VarDouble * _v_deadline;
+  VarList * _v_skew_list;
+  std::vector<VarDouble *> _v_skew;
+
+  std::mutex group_mutex;
+  std::condition_variable group_changed;
+  std::vector<Entry> group;
+  int group_size;
+  double group_t_capture;
+  double group_first_arrival;
+  std::chrono::steady_clock::time_point group_deadline;
+  /// arrival skew per camera in seconds, guarded by group_mutex
+  std::vector<double> skew;
+  std::function<bool(int)> camera_active;
+  //taken before group_mutex is released, so that groups are sent in the order they were closed
+  std::mutex send_mutex;
+
+  std::thread deadline_thread;
+  bool running;
+
+  static double now();
+  int countActiveCameras() const;
+  /// moves the frames of the current group to \p ready and starts a new group
+  void takeGroupLocked(std::vector<Outgoing> & ready);
+  void send(std::vector<Outgoing> & ready);
+  void runDeadlines();
+
+public:
+  DetectionAggregator(RoboCupSSLServer * udp_server, int num_cameras);
+  ~DetectionAggregator();
+
+  VarList * getSettings();
+  bool isEnabled() const;
+  /// \p active tells whether camera i currently captures. Without it, all cameras are waited for.
+  /// It is called on the processing threads and must not block.
+  void setCameraActivity(const std::function<bool(int)> & active);
+
+  /// hands over the detection frame of stack \p camera.
+  /// t_sent is set when the group is sent.
+  void submit(int camera, const SSL_DetectionFrame & frame);
+
+  /// copies the arrival skews into the settings tree. Call it from the thread owning the VarTypes.
+  void publishStatistics();
+};
+
+#endif
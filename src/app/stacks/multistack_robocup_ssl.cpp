@@ -21,11 +21,17 @@
 #include "multistack_robocup_ssl.h"
 #include "capture_splitter.h"
 #include "DistributorStack.h"
+#include "task_pool.h"
+#include "simd_dispatch.h"
 
-MultiStackRoboCupSSL::MultiStackRoboCupSSL(RenderOptions *_opts, int num_normal_camera_threads) :
+MultiStackRoboCupSSL::MultiStackRoboCupSSL(RenderOptions *_opts, int num_normal_camera_threads, bool headless) :
     MultiVisionStack("RoboCup SSL Multi-Cam",_opts),
     ds_udp_server_new(NULL),
-    ds_udp_server_old(NULL) {
+    ds_udp_server_old(NULL),
+    detection_aggregator(NULL) {
+  //create the shared task pool on this thread, so that its workers inherit our processor placement
+  TaskPool::getInstance();
+
   //add global field calibration parameter
   global_field = new RoboCupField();
   settings->addChild(global_field->getSettings());
@@ -75,6 +81,22 @@ MultiStackRoboCupSSL::MultiStackRoboCupSSL(RenderOptions *_opts, int num_normal_
   ds_udp_server_new = new RoboCupSSLServer(10006, "224.5.23.2");
   ds_udp_server_old = new RoboCupSSLServer(10005, "224.5.23.2");
 
+  detection_aggregator = new DetectionAggregator(ds_udp_server_new, num_normal_camera_threads);
+  settings->addChild(detection_aggregator->getSettings());
+
+  settings->addChild(simd_kernels = new VarStringEnum("SIMD kernels", "auto"));
+  simd_kernels->addItem("auto");
+  for (int level = SimdScalar; level < SimdLevelCount; level++) {
+    simd_kernels->addItem(SimdDispatch::getLevelName((SimdLevel)level));
+  }
+  settings->addChild(simd_active = new VarString("active SIMD kernels", ""));
+  simd_active->addFlags(VARTYPE_FLAG_READONLY | VARTYPE_FLAG_NOSTORE);
+  connect(simd_kernels,
+          SIGNAL(hasChanged(VarType *)),
+          this,
+          SLOT(RefreshSimdKernels()));
+  RefreshSimdKernels();
+
   global_plugin_publish_geometry = new  PluginPublishGeometry(
       0,
       ds_udp_server_new,
@@ -91,12 +113,14 @@ MultiStackRoboCupSSL::MultiStackRoboCupSSL(RenderOptions *_opts, int num_normal_
   num_threads++;
 #endif
   createThreads(num_threads, num_normal_camera_threads);
+  //idle cameras and cameras without a capture module never report, so they are not waited for
+  detection_aggregator->setCameraActivity([this](int camera) { return threads[camera]->isCapturing(); });
   for (int i = 0; i < num_normal_camera_threads;i++) {
     //NOTE: if modified to put different stacks in cameras, please
     //      update the plugin_colorcalib.cpp code to safely reallocate and copy their
     //      data instead of assuming that format and size is uniform across
     //      cameras -- added when LUTs became aware of other cameras (Zavesky, 2/16)
-    threads[i]->setFrameBuffer(new FrameBuffer(3));
+    threads[i]->setFrameBuffer(new TripleBuffer<FrameData>());
     threads[i]->setStack(
         new StackRoboCupSSL(
             _opts,threads[i]->getFrameBuffer(),
@@ -110,7 +134,9 @@ MultiStackRoboCupSSL::MultiStackRoboCupSSL(RenderOptions *_opts, int num_normal_
             global_team_selector_yellow,
             ds_udp_server_new,
             ds_udp_server_old,
-            "robocup-ssl-cam-" + QString::number(i).toStdString()));
+            "robocup-ssl-cam-" + QString::number(i).toStdString(),
+            detection_aggregator,
+            headless));
   }
 
 #ifdef CAMERA_SPLITTER
@@ -120,7 +146,7 @@ MultiStackRoboCupSSL::MultiStackRoboCupSSL(RenderOptions *_opts, int num_normal_
   for (unsigned int i = 0; i < num_normal_camera_threads;i++) {
     captureSplitters[i] = dynamic_cast<CaptureSplitter*>(threads[i]->getCaptureSplitter());
   }
-  threads[num_normal_camera_threads]->setFrameBuffer(new FrameBuffer(3));
+  threads[num_normal_camera_threads]->setFrameBuffer(new TripleBuffer<FrameData>());
   threads[num_normal_camera_threads]->setStack(
           new DistributorStack(
                   _opts,
@@ -133,8 +159,14 @@ string MultiStackRoboCupSSL::getSettingsFileName() {
   return "robocup-ssl";
 }
 
+void MultiStackRoboCupSSL::publishStatistics() {
+  MultiVisionStack::publishStatistics();
+  detection_aggregator->publishStatistics();
+}
+
 MultiStackRoboCupSSL::~MultiStackRoboCupSSL() {
   stop();
+  delete detection_aggregator;
   delete ds_udp_server_new;
   delete ds_udp_server_old;
   delete global_plugin_publish_geometry;
@@ -161,6 +193,13 @@ void MultiStackRoboCupSSL::UpdateServerSettings(const int port,
   server->mutex.unlock();
 }
 
+void MultiStackRoboCupSSL::RefreshSimdKernels() {
+  SimdDispatch::setMaxLevel(SimdDispatch::parseLevelName(simd_kernels->getString()));
+  SimdLevel active = SimdDispatch::getActiveLevel();
+  simd_active->setString(string(SimdDispatch::getLevelName(active)) + " (supported: " +
+                         SimdDispatch::getLevelName(SimdDispatch::getSupportedLevel()) + ")");
+}
+
 void MultiStackRoboCupSSL::RefreshLegacyNetworkOutput() {
   const string address =
       legacy_network_output_settings->multicast_address->getString();
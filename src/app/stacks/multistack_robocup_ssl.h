@@ -29,6 +29,7 @@
 #include "cmpattern_teamdetector.h"
 #include "robocup_ssl_server.h"
 #include "field.h"
+#include "detection_aggregator.h"
 using namespace std;
 
 /*!
@@ -53,13 +54,23 @@ class MultiStackRoboCupSSL : public QObject, public MultiVisionStack {
   RoboCupSSLServer * ds_udp_server_new;
   // UDP Server for Double-Sized field, old protobuf format.
   RoboCupSSLServer * ds_udp_server_old;
+  // optionally merges the detections of all cameras per capture instant
+  DetectionAggregator * detection_aggregator;
+  // limits the SIMD kernels used by all cameras, e.g. for comparing them
+  VarStringEnum * simd_kernels;
+  // the SIMD kernels actually selected, given what the CPU supports
+  VarString * simd_active;
   public:
-  MultiStackRoboCupSSL(RenderOptions *_opts, int num_normal_camera_threads);
+  /// a \p headless multi-stack only constructs the processing plugins (see StackRoboCupSSL)
+  MultiStackRoboCupSSL(RenderOptions *_opts, int num_normal_camera_threads, bool headless = false);
   virtual string getSettingsFileName();
+  /// also publishes the arrival skews of the detection aggregator
+  virtual void publishStatistics();
   virtual ~MultiStackRoboCupSSL();
   public slots:
   void RefreshNetworkOutput();
   void RefreshLegacyNetworkOutput();
+  void RefreshSimdKernels();
   private:
   void UpdateServerSettings(const int port,
                             const string& address,
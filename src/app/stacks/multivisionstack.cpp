@@ -62,6 +62,12 @@ void MultiVisionStack::start() {
   }
 }
 
+void MultiVisionStack::publishStatistics() {
+  for (CaptureThread * t : threads) {
+    if (t->getStack()!=0) t->getStack()->publishStatistics();
+  }
+}
+
 void MultiVisionStack::stop() {
   unsigned int n=threads.size();
   CaptureThread * t;
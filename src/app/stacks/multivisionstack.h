@@ -56,6 +56,8 @@ public:
 
     void start();
     void stop();
+    /// publishes the statistics of the plugins of all threads, see VisionPlugin::publishStatistics()
+    virtual void publishStatistics();
 
     /*virtual void keyPressEvent ( QKeyEvent * event );
     virtual void mousePressEvent ( QMouseEvent * event, pixelloc loc );
@@ -19,7 +19,9 @@
 */
 //========================================================================
 #include "stack_robocup_ssl.h"
+#ifndef VISION_HEADLESS
 #include <plugin_camera_intrinsic_calib.h>
+#endif
 
 StackRoboCupSSL::StackRoboCupSSL(
     RenderOptions * _opts,
@@ -34,7 +36,9 @@ StackRoboCupSSL::StackRoboCupSSL(
     CMPattern::TeamSelector * _global_team_selector_yellow,
     RoboCupSSLServer * ds_udp_server_new,
     RoboCupSSLServer * ds_udp_server_old,
-    string cam_settings_filename) :
+    string cam_settings_filename,
+    DetectionAggregator * detection_aggregator,
+    bool headless) :
     VisionStack(_opts),
     _camera_id(camera_id),
     _cam_settings_filename(cam_settings_filename),
@@ -58,23 +62,47 @@ StackRoboCupSSL::StackRoboCupSSL(
   _global_plugin_publish_geometry->addCameraParameters(camera_parameters);
   _legacy_plugin_publish_geometry->addCameraParameters(camera_parameters);
 
-  auto *pluginColorCalibration = new PluginColorCalibration(_fb, lut_yuv, *_image_mask, LUTChannelMode_Numeric);
-
-  stack.push_back(new PluginDVR(_fb));
+#ifdef VISION_HEADLESS
+  (void)headless;
+#else
+  PluginColorCalibration * pluginColorCalibration = 0;
+  if (!headless) {
+    pluginColorCalibration = new PluginColorCalibration(_fb, lut_yuv, *_image_mask, LUTChannelMode_Numeric);
+    stack.push_back(new PluginDVR(_fb));
+  }
+#endif
 
   // must come before all others
   stack.push_back(new PluginMask(_fb, *_image_mask));
 
-  stack.push_back(pluginColorCalibration);
+#ifndef VISION_HEADLESS
+  if (!headless) {
+    stack.push_back(pluginColorCalibration);
+  }
+#endif
 
   stack.push_back(new PluginCameraCalibration(_fb,*camera_parameters, *global_field));
 
-  stack.push_back(new PluginColorThreshold(_fb,lut_yuv, *_image_mask));
+  PluginRegionOfInterest * region_of_interest = new PluginRegionOfInterest(_fb, lut_yuv, *_image_mask);
+  stack.push_back(region_of_interest);
+
+  //the run length encoder can take over thresholding (fused mode), so it is created first
+  PluginRunlengthEncode * runlength_encode = new PluginRunlengthEncode(_fb, lut_yuv, _image_mask);
+  PluginColorThreshold * color_threshold = new PluginColorThreshold(_fb,lut_yuv, *_image_mask, runlength_encode);
+  stack.push_back(color_threshold);
+  //fused thresholding is split up like the one of the color threshold plugin
+  runlength_encode->setThreadCount([color_threshold]() {
+    return color_threshold->getNumThreads();
+  });
 
-  stack.push_back(
-      new PluginCameraIntrinsicCalibration(_fb, *camera_parameters));
+#ifndef VISION_HEADLESS
+  if (!headless) {
+    stack.push_back(
+        new PluginCameraIntrinsicCalibration(_fb, *camera_parameters));
+  }
+#endif
 
-  stack.push_back(new PluginRunlengthEncode(_fb));
+  stack.push_back(runlength_encode);
 
   stack.push_back(new PluginFindBlobs(_fb,lut_yuv));
 
@@ -82,13 +110,30 @@ StackRoboCupSSL::StackRoboCupSSL(
 
   stack.push_back(new PluginDetectBalls(_fb,lut_yuv,*camera_parameters,*global_field,global_ball_settings));
 
-  stack.push_back(new PluginAutoColorCalibration(_fb,lut_yuv, (LUTWidget*) pluginColorCalibration->getControlWidget()));
+  //the detections of this frame determine the region of interest of the next ones
+  stack.push_back(new PluginRegionOfInterestUpdate(_fb, region_of_interest));
+
+  //in fused mode, the thresholded image is only written while the histogram checks or the visualization read it
+  runlength_encode->addThresholdImageConsumer([_global_ball_settings]() {
+    return _global_ball_settings->isHistogramEnabled();
+  });
+  runlength_encode->addThresholdImageConsumer([_global_team_settings]() {
+    return _global_team_settings->getRobotPattern()->isHistogramEnabled();
+  });
+
+#ifndef VISION_HEADLESS
+  if (!headless) {
+    stack.push_back(new PluginAutoColorCalibration(_fb,lut_yuv, (LUTWidget*) pluginColorCalibration->getControlWidget()));
+  }
+#endif
 
   stack.push_back(new PluginSSLNetworkOutput(
       _fb,
       _ds_udp_server_new,
       *camera_parameters,
-      *global_field));
+      *global_field,
+      detection_aggregator,
+      _camera_id));
 
   stack.push_back(new PluginLegacySSLNetworkOutput(
       _fb,
@@ -99,9 +144,16 @@ StackRoboCupSSL::StackRoboCupSSL(
   stack.push_back(_global_plugin_publish_geometry);
   stack.push_back(_legacy_plugin_publish_geometry);
 
-  PluginVisualize * vis = new PluginVisualize(_fb,*camera_parameters,*global_field, *_image_mask);
-  vis->setThresholdingLUT(lut_yuv);
-  stack.push_back(vis);
+#ifndef VISION_HEADLESS
+  if (!headless) {
+    PluginVisualize * vis = new PluginVisualize(_fb,*camera_parameters,*global_field, *_image_mask);
+    vis->setThresholdingLUT(lut_yuv);
+    stack.push_back(vis);
+    runlength_encode->addThresholdImageConsumer([vis]() {
+      return vis->isActive();
+    });
+  }
+#endif
 }
 string StackRoboCupSSL::getSettingsFileName() {
   return _cam_settings_filename;
@@ -26,10 +26,13 @@
 #include "camera_calibration.h"
 #include "camera_parameters.h"
 #include "field.h"
+#ifndef VISION_HEADLESS
 #include "plugin_dvr.h"
 #include "plugin_colorcalib.h"
-#include "plugin_cameracalib.h"
 #include "plugin_visualize.h"
+#include "plugin_auto_color_calibration.h"
+#endif
+#include "plugin_cameracalib.h"
 #include "plugin_colorthreshold.h"
 #include "plugin_runlength_encode.h"
 #include "plugin_find_blobs.h"
@@ -39,12 +42,12 @@
 #include "plugin_publishgeometry.h"
 #include "plugin_legacysslnetworkoutput.h"
 #include "plugin_legacypublishgeometry.h"
-#include "plugin_auto_color_calibration.h"
-#include "plugin_dvr.h"
 #include "cmpattern_teamdetector.h"
 #include "robocup_ssl_server.h"
 #include "convex_hull_image_mask.h"
 #include "plugin_mask.h"
+#include "plugin_region_of_interest.h"
+#include "detection_aggregator.h"
 
 using namespace std;
 
@@ -53,6 +56,11 @@ using namespace std;
   \brief   The single camera vision stack implementation used for the RoboCup SSL
   \author  Stefan Zickler, (C) 2008
            multiple of these stacks are run in parallel using the MultiStackRoboCupSSL
+
+  A headless stack only contains the plugins needed to produce the network output,
+  and none of the calibration, recording or visualization plugins.
+  The vision-headless binary is built with VISION_HEADLESS, which leaves out those
+  plugins and their widgets entirely.
 */
 class StackRoboCupSSL : public VisionStack {
   protected:
@@ -83,7 +91,9 @@ class StackRoboCupSSL : public VisionStack {
                   CMPattern::TeamSelector* _global_team_selector_yellow,
                   RoboCupSSLServer* ds_udp_server_new,
                   RoboCupSSLServer* ds_udp_server_old,
-                  string cam_settings_filename);
+                  string cam_settings_filename,
+                  DetectionAggregator* detection_aggregator = nullptr,
+                  bool headless = false);
   virtual string getSettingsFileName();
   ~StackRoboCupSSL() override;
 };
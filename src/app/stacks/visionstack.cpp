@@ -22,13 +22,26 @@
 #include <iomanip>
 #include <iostream>
 #include <chrono>
+#include <atomic>
+#include <memory>
+#include <functional>
+#include "task_pool.h"
 
-VisionStack::VisionStack(RenderOptions * _opts) {
+VisionStack::VisionStack(RenderOptions * _opts)
+  : snapshot([this](Settings & s) {
+      s.print_timings=_v_print_timings->getBool();
+      s.parallel_plugins=_v_parallel_plugins->getBool();
+    }) {
   opts=_opts;
   settings=new VarList("Global");
   // timings should only be printed on demand for a short period of time by temporally activating this flag
   _v_print_timings = new VarBool("print stack timings", false);
   settings->addChild(_v_print_timings);
+  // run plugins which do not depend on each other's results concurrently
+  _v_parallel_plugins = new VarBool("parallel plugins", false);
+  settings->addChild(_v_parallel_plugins);
+  snapshot.watch(settings);
+  schedule_size=0;
 }
 
 VisionStack::~VisionStack() {
@@ -40,41 +53,174 @@ VarList * VisionStack::getSettings() {
 }
 
 void VisionStack::process(FrameData * data) {
-  if(_v_print_timings->getBool()) {
+  Settings s=*snapshot.get();
+  if(s.parallel_plugins) {
+    processScheduled(data);
+    return;
+  }
+  if(s.print_timings) {
+    vector<long long> durations(stack.size());
     auto totalStart = std::chrono::steady_clock::now();
-    for (auto p : stack) {
+    for (unsigned int i=0;i<stack.size();i++) {
+      VisionPlugin * p=stack[i];
       p->lock();
       auto start = std::chrono::steady_clock::now();
-      p->process(data,opts);
-      auto duration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
-      std::cout << std::setw(23) << std::left << p->getName()
-                << std::setw(5) << std::right << duration.count() << " μs" << std::endl;
+      if (p->isActive()) p->process(data,opts);
+      durations[i] = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
       p->unlock();
     }
-    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - totalStart);
-    std::cout << std::setw(23) << std::left << "All"
-              << std::setw(5) << std::right << duration.count() << " μs" << std::endl << std::endl;
+    printTimings(durations, std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - totalStart).count());
   } else {
     for (auto p : stack) {
       p->lock();
-      p->process(data,opts);
+      if (p->isActive()) p->process(data,opts);
       p->unlock();
     }
   }
 }
 
+void VisionStack::printTimings(const vector<long long> & durations_us, long long total_us) {
+  for (unsigned int i=0;i<stack.size();i++) {
+    std::cout << std::setw(23) << std::left << stack[i]->getName()
+              << std::setw(5) << std::right << durations_us[i] << " μs" << std::endl;
+  }
+  std::cout << std::setw(23) << std::left << "All"
+            << std::setw(5) << std::right << total_us << " μs" << std::endl << std::endl;
+}
+
+static bool intersects(const vector<int> & a, const vector<int> & b) {
+  for (auto x : a) {
+    for (auto y : b) {
+      if (x==y) return true;
+    }
+  }
+  return false;
+}
+
+void VisionStack::buildSchedule() {
+  int n=stack.size();
+  successors.assign(n, vector<int>());
+  num_predecessors.assign(n, 0);
+  roots.clear();
+  for (int i=0;i<n;i++) {
+    VisionPlugin * p=stack[i];
+    for (int j=0;j<i;j++) {
+      VisionPlugin * q=stack[j];
+      bool depends = !p->hasDeclaredAccess() || !q->hasDeclaredAccess()
+                     || intersects(q->getWrites(), p->getReads())
+                     || intersects(q->getReads(), p->getWrites())
+                     || intersects(q->getWrites(), p->getWrites());
+      if (depends) {
+        successors[j].push_back(i);
+        num_predecessors[i]++;
+      }
+    }
+    if (num_predecessors[i]==0) roots.push_back(i);
+  }
+  schedule_size=n;
+}
+
+void VisionStack::processScheduled(FrameData * data) {
+  {
+    const std::lock_guard<std::mutex> lock(schedule_mutex);
+    if (schedule_size != stack.size()) buildSchedule();
+  }
+  int n=stack.size();
+  if (n==0) return;
+  std::unique_ptr<std::atomic<int>[]> remaining(new std::atomic<int>[n]);
+  for (int i=0;i<n;i++) remaining[i]=num_predecessors[i];
+  bool print_timings=snapshot.get()->print_timings;
+  vector<long long> durations(n);
+  auto total_start = std::chrono::steady_clock::now();
+
+  TaskGroup group;
+  //runs plugin i, then continues with the first plugin that became ready and forks all others
+  std::function<void(int)> run = [&](int i) {
+    while (i >= 0) {
+      VisionPlugin * p=stack[i];
+      p->lock();
+      auto start = std::chrono::steady_clock::now();
+      if (p->isActive()) p->process(data,opts);
+      if (print_timings) {
+        durations[i] = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+      }
+      p->unlock();
+      int next=-1;
+      for (int s : successors[i]) {
+        if (--remaining[s] == 0) {
+          if (next < 0) {
+            next=s;
+          } else {
+            group.run([&run, s]() { run(s); });
+          }
+        }
+      }
+      i=next;
+    }
+  };
+  for (unsigned int r=1;r<roots.size();r++) {
+    int root=roots[r];
+    group.run([&run, root]() { run(root); });
+  }
+  run(roots[0]);
+  group.wait();
+
+  if (print_timings) {
+    printTimings(durations, std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - total_start).count());
+  }
+}
+
+bool VisionStack::processInSequence(FrameData * data, long long seq) {
+  int n=stack.size();
+  for (int i=0;i<n;i++) {
+    VisionPlugin * p=stack[i];
+    if (p->isFrameParallel()) {
+      p->lockShared();
+      if (p->isActive()) p->process(data,opts);
+      p->unlock();
+    } else {
+      if (sequencer.enter(i,seq)==false) return false;
+      p->lock();
+      if (p->isActive()) p->process(data,opts);
+      p->unlock();
+      sequencer.leave(i,seq);
+    }
+  }
+  return true;
+}
+
+void VisionStack::resetSequence(long long next_seq) {
+  sequencer.reset(stack.size(),next_seq);
+}
+
+void VisionStack::abortSequence() {
+  sequencer.abort();
+}
+
 void VisionStack::postProcess(FrameData * data) {
   for (auto p : stack) {
     p->lock();
-    p->postProcess(data,opts);
+    if (p->isActive()) p->postProcess(data,opts);
     p->unlock();
   }
 }
 
+void VisionStack::setDisplayed(bool displayed) {
+  for (auto p : stack) {
+    p->setDisplayed(displayed);
+  }
+}
+
 void VisionStack::updateTimingStatistics() {
 
 }
 
+void VisionStack::publishStatistics() {
+  for (auto p : stack) {
+    p->publishStatistics();
+  }
+}
+
 void VisionStack::keyPressEvent ( QKeyEvent * event ) {
   unsigned int n=stack.size();
   VisionPlugin * p;
@@ -23,19 +23,45 @@
 
 #include "visionplugin.h"
 #include "framedata.h"
+#include "frame_sequencer.h"
 #include "timer.h"
+#include "settings_snapshot.h"
+#include <mutex>
 using namespace std;
 
 /*!
   \class   VisionStack
   \brief   Base-class of a single-threaded / single-camera vision stack.
   \author  Stefan Zickler, (C) 2008
+
+  If "parallel plugins" is enabled, process() derives a dependency graph from
+  the FrameData access the plugins declared: a plugin depends on every earlier
+  plugin that writes what it reads, reads what it writes, or writes what it
+  writes. Plugins without declared access depend on, and are depended upon by,
+  all others. Independent plugins are run concurrently on the TaskPool.
 */
 class VisionStack {
 protected:
   RenderOptions * opts;
   VarList * settings;
   VarBool * _v_print_timings;
+  VarBool * _v_parallel_plugins;
+  struct Settings {
+    bool print_timings;
+    bool parallel_plugins;
+  };
+  SettingsSnapshot<Settings> snapshot;
+  FrameSequencer sequencer; //orders frames at plugins that are not frame-parallel
+
+  //the plugin dependency graph, built on first use
+  std::mutex schedule_mutex;
+  unsigned int schedule_size;
+  vector<vector<int> > successors;
+  vector<int> num_predecessors;
+  vector<int> roots;
+  void buildSchedule();
+  void processScheduled(FrameData * data);
+  void printTimings(const vector<long long> & durations_us, long long total_us);
 public:
     VisionStack(RenderOptions * _opts);
     virtual ~VisionStack();
@@ -44,8 +70,23 @@ public:
     VarList * getSettings();
 
     void process(FrameData * data);
+
+    /// processes frame number \p seq, while other frames of the same camera may
+    /// be processed concurrently on other threads. Frame-parallel plugins run
+    /// concurrently, all others see the frames one at a time in sequence order.
+    /// the plugins of one frame run in stack order here, as frames already overlap.
+    /// returns false if processing was aborted.
+    bool processInSequence(FrameData * data, long long seq);
+    /// starts a new sequence, \p next_seq being the number of the next frame
+    void resetSequence(long long next_seq);
+    /// releases all threads waiting in processInSequence()
+    void abortSequence();
     void postProcess(FrameData * data);
+    /// tells all plugins whether the visualization of this stack is on the screen
+    void setDisplayed(bool displayed);
     void updateTimingStatistics();
+    /// calls VisionPlugin::publishStatistics() on all plugins
+    void publishStatistics();
 
     virtual void keyPressEvent ( QKeyEvent * event );
     virtual void mousePressEvent ( QMouseEvent * event, pixelloc loc );
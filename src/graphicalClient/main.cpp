@@ -23,7 +23,6 @@
 #include <QtGui>
 #include <QApplication>
 #include "soccerview.h"
-#include "timer.h"
 
 GLSoccerView *view;
 
@@ -34,11 +33,13 @@ class MyThread : public QThread
 protected:
   void run()
   {
-    static const double minDuration = 0.01; //100FPS
+    //the timeout only bounds the time it takes to notice that the application quit
+    static const int waitTimeoutMs = 100;
     RoboCupSSLClient client(m_port);
     client.open(false);
     SSL_WrapperPacket packet;
     while(runApp) {
+      if (!client.wait(waitTimeoutMs)) continue;
       while (client.receive(packet)) {
         if (packet.has_detection()) {
           SSL_DetectionFrame detection = packet.detection();
@@ -48,7 +49,6 @@ protected:
           view->updateFieldGeometry(packet.geometry().field());
         }
       }
-      Sleep(minDuration);
     }
   }
   
@@ -104,14 +104,40 @@ bool CaptureGenerator::copyAndConvertFrame ( const RawImage & src, RawImage & ta
   return true;
 }
 
+bool CaptureGenerator::setLeaseCount ( int count )
+{
+  mutex.lock();
+  frames.setLeaseCount ( count );
+  mutex.unlock();
+  return true;
+}
+
+bool CaptureGenerator::leaseFrame ( const RawImage & src, RawImage & target )
+{
+  mutex.lock();
+  ColorFormat output_fmt = Colors::stringToColorFormat ( v_colorout->getSelection().c_str() );
+  bool res = ( output_fmt == src.getColorFormat() && frames.lease ( src, target ) );
+  mutex.unlock();
+  return res;
+}
+
+void CaptureGenerator::releaseLease ( const RawImage & leased )
+{
+  mutex.lock();
+  frames.release ( leased );
+  mutex.unlock();
+}
+
 RawImage CaptureGenerator::getFrame()
 {
   mutex.lock();
   limit.waitForNextFrame();
+  //leased frames are still in use, so the next frame goes into another buffer
+  RawImage & result=frames.next();
   result.setColorFormat ( COLOR_RGB8 );
   result.setTime ( GetTimeSec() );
   result.setTimeCam( GetTimeSec() );
-  result.allocate ( COLOR_RGB8,v_width->getInt(),v_height->getInt() );
+  result.ensure_allocation ( COLOR_RGB8,v_width->getInt(),v_height->getInt() );
   rgbImage img;
   img.fromRawImage(result);
 
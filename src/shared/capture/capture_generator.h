@@ -23,6 +23,7 @@
 #define CAPTUREGENERATOR_H
 
 #include "captureinterface.h"
+#include "leasable_frames.h"
 #include <string>
 #include "VarTypes.h"
 #include "framecounter.h"
@@ -44,7 +45,7 @@ class CaptureGenerator : public QObject, public CaptureInterface
 
 protected:
   bool is_capturing;
-  RawImage result;
+  LeasableFrames frames;
   FrameLimiter limit;
   //processing variables:
   VarStringEnum * v_colorout;
@@ -72,6 +73,9 @@ public:
   void cleanup();
 
   virtual bool copyAndConvertFrame(const RawImage & src, RawImage & target);
+  virtual bool setLeaseCount(int count);
+  virtual bool leaseFrame(const RawImage & src, RawImage & target);
+  virtual void releaseLease(const RawImage & leased);
   virtual string getCaptureMethodName() const;
 };
 
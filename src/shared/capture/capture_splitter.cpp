@@ -48,6 +48,8 @@ CaptureSplitter::CaptureSplitter(VarList * _settings, int default_camera_id, QOb
     settings->addChild(relative_height = new VarDouble("Relative height", 1.0, 0.0, 1.0));
     settings->addChild(relative_width = new VarDouble("Relative width", 1.0, 0.0, 1.0));
   }
+  //without demosaicing, bayer images are thresholded directly from their 2x2 quads
+  settings->addChild(convert_bayer = new VarBool("Convert Bayer to RGB", true));
 
   image_buffer = new RawImage();
 }
@@ -139,7 +141,12 @@ bool CaptureSplitter::copyAndConvertFrame(const RawImage &src, RawImage &target)
             pixel_size * width);
   }
 
-  target.ensure_allocation(ColorFormat::COLOR_RGB8, width, height);
+  ColorFormat target_format = ColorFormat::COLOR_RGB8;
+  if(image_buffer->getColorFormat() == ColorFormat::COLOR_RAW8 && !convert_bayer->getBool())
+  {
+    target_format = ColorFormat::COLOR_RAW8;
+  }
+  target.ensure_allocation(target_format, width, height);
 
   if(target.getData() == nullptr)
   {
@@ -148,13 +155,13 @@ bool CaptureSplitter::copyAndConvertFrame(const RawImage &src, RawImage &target)
     return false;
   }
 
-  if(image_buffer->getColorFormat() == ColorFormat::COLOR_RAW8)
+  if(image_buffer->getColorFormat() == ColorFormat::COLOR_RAW8 && target_format == ColorFormat::COLOR_RGB8)
   {
     cv::Mat srcMat(height, width, CV_8UC1, data_buf);
     cv::Mat dstMat(height, width, CV_8UC3, target.getData());
     cvtColor(srcMat, dstMat, cv::COLOR_BayerBG2RGB);
   }
-  else if(target.getColorFormat() == ColorFormat::COLOR_RGB8)
+  else if(target.getColorFormat() == image_buffer->getColorFormat())
   {
     memcpy(target.getData(), image_buffer->getData(), static_cast<size_t>(image_buffer->getNumBytes()));
   }
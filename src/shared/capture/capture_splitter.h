@@ -38,6 +38,7 @@ protected:
   VarDouble* relative_width_offset;
   VarDouble* relative_width;
   VarDouble* relative_height;
+  VarBool* convert_bayer;
 
   RawImage* full_image;
   RawImage* image_buffer;
@@ -32,9 +32,11 @@ CaptureVideo::CaptureVideo(VarList* settings) : CaptureInterface(settings) {
 RawImage CaptureVideo::getFrame() {
   if(!capture.read(frame)) {
     std::cout << "End of video stream reached" << std::endl;
-    return img;
+    return frames.last();
   }
 
+  //leased frames are still in use, so the next frame goes into another buffer
+  RawImage & img = frames.next();
   int factor = v_cap_upscale->getBool() ? 2 : 1;
   img.ensure_allocation(ColorFormat::COLOR_RGB8, factor*frame.cols, factor*frame.rows);
   cv::Mat dstImg(img.getHeight(), img.getWidth(), CV_8UC3, img.getData());
@@ -59,7 +61,24 @@ RawImage CaptureVideo::getFrame() {
 }
 
 void CaptureVideo::releaseFrame() {
-  // frame and img are not cleared here to prevent unnecessary reallocation with the next frame.
+  // frame and the output buffers are not cleared here to prevent unnecessary reallocation with the next frame.
+}
+
+bool CaptureVideo::setLeaseCount(int count) {
+  frames.setLeaseCount(count);
+  return true;
+}
+
+bool CaptureVideo::leaseFrame(const RawImage & src, RawImage & target) {
+  // frames are already converted to RGB8 in getFrame(), so they can be handed out as-is
+  if (src.getColorFormat() != COLOR_RGB8) {
+    return false;
+  }
+  return frames.lease(src, target);
+}
+
+void CaptureVideo::releaseLease(const RawImage & leased) {
+  frames.release(leased);
 }
 
 
@@ -25,6 +25,7 @@
 #include <opencv2/videoio.hpp>
 
 #include "captureinterface.h"
+#include "leasable_frames.h"
 
 class CaptureVideo : public CaptureInterface {
  public:
@@ -33,6 +34,9 @@ class CaptureVideo : public CaptureInterface {
   RawImage getFrame() override;
   bool isCapturing() override;
   void releaseFrame() override;
+  bool setLeaseCount(int count) override;
+  bool leaseFrame(const RawImage & src, RawImage & target) override;
+  void releaseLease(const RawImage & leased) override;
   bool startCapture() override;
   bool stopCapture() override;
   string getCaptureMethodName() const override;
@@ -43,7 +47,7 @@ class CaptureVideo : public CaptureInterface {
 
   cv::Mat frame;
   cv::VideoCapture capture;
-  RawImage img;
+  LeasableFrames frames;
   double timestamp;
 
   bool is_capturing = false;
@@ -60,6 +60,8 @@ CaptureDC1394v2::CaptureDC1394v2(VarList * _settings,int default_camera_id, QObj
   cam_list=0;
   cam_id=default_camera_id;
   camera=0;
+  frame=0;
+  lease_count=0;
   is_capturing=false;
     mutex.lock();
 
@@ -846,6 +848,9 @@ void CaptureDC1394v2::cleanup()
     dc1394_camera_free(camera);
   }
   camera=0;
+  frame=0;
+  //the DMA buffers are gone with the capture
+  leased_frames.clear();
   //TODO: cleanup/free any memory buffers.
 
   is_capturing=false;
@@ -935,7 +940,8 @@ bool CaptureDC1394v2::startCapture()
   capture_format=Colors::stringToColorFormat(v_colormode->getString().c_str());
   int fps=v_fps->getInt();
   CaptureMode mode=stringToCaptureMode(v_format->getString().c_str());
-  ring_buffer_size=v_buffer_size->getInt();
+  //leased frames are held outside of the DMA ring, which keeps its configured size besides them
+  ring_buffer_size=v_buffer_size->getInt() + lease_count;
   bool use_1394B=v_use1394B->getBool();
   dc1394speed_t iso_speed=(v_use_iso_800->getBool() ? DC1394_ISO_SPEED_800 : DC1394_ISO_SPEED_400);
 
@@ -1426,6 +1432,44 @@ bool CaptureDC1394v2::copyAndConvertFrame(const RawImage & src, RawImage & targe
 }
 
 
+bool CaptureDC1394v2::setLeaseCount(int count)
+{
+  mutex.lock();
+  lease_count=count;
+  mutex.unlock();
+  return true;
+}
+
+bool CaptureDC1394v2::leaseFrame(const RawImage & src, RawImage & target)
+{
+  mutex.lock();
+  // the leased DMA buffer is taken out of the ring until releaseLease()
+  bool res = (Colors::stringToColorFormat(v_colorout->getSelection().c_str()) == src.getColorFormat()
+              && frame != 0 && src.getData() == frame->image && (int)leased_frames.size() < lease_count);
+  if (res) {
+    leased_frames.push_back(frame);
+    frame=0;
+    target.lease(src);
+  }
+  mutex.unlock();
+  return res;
+}
+
+void CaptureDC1394v2::releaseLease(const RawImage & leased)
+{
+  mutex.lock();
+  for (size_t i=0;i<leased_frames.size();i++) {
+    if (leased_frames[i]->image == leased.getData()) {
+      if (dc1394_capture_enqueue (camera, leased_frames[i]) !=DC1394_SUCCESS) {
+        fprintf (stderr, "CaptureDC1394v2 Error: Failed to release leased frame from camera %d\n", cam_id);
+      }
+      leased_frames.erase(leased_frames.begin() + i);
+      break;
+    }
+  }
+  mutex.unlock();
+}
+
 bool CaptureDC1394v2::convertFrame(const RawImage & src, RawImage & target, ColorFormat output_fmt,
                          bool debayer, dc1394color_filter_t bayer_format,dc1394bayer_method_t bayer_method, int y16bits)
 {
@@ -1516,6 +1560,7 @@ RawImage CaptureDC1394v2::getFrame()
   if (dc1394_capture_dequeue(camera, DC1394_CAPTURE_POLICY_WAIT, &frame)!=DC1394_SUCCESS) {
     fprintf (stderr, "CaptureDC1394v2 Error: Failed to capture from camera %d\n", cam_id);
     is_capturing=false;
+    frame=0;
     result.setData(0);
   } else {
     /*
@@ -1538,8 +1583,12 @@ RawImage CaptureDC1394v2::getFrame()
 
 void CaptureDC1394v2::releaseFrame() {
     mutex.lock();
-  if (dc1394_capture_enqueue (camera, frame) !=DC1394_SUCCESS) {
-    fprintf (stderr, "CaptureDC1394v2 Error: Failed to release frame from camera %d\n", cam_id);
+  //a leased frame is enqueued by releaseLease() instead
+  if (frame!=0) {
+    if (dc1394_capture_enqueue (camera, frame) !=DC1394_SUCCESS) {
+      fprintf (stderr, "CaptureDC1394v2 Error: Failed to release frame from camera %d\n", cam_id);
+    }
+    frame=0;
   }
     mutex.unlock();
 }
@@ -26,6 +26,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string>
+#include <vector>
 #include "VarTypes.h"
 #include <dc1394/control.h>
 #include <dc1394/conversions.h>
@@ -337,6 +338,7 @@ protected:
   int left;
   ColorFormat capture_format;
   int ring_buffer_size;
+  int lease_count;
   dc1394camera_list_t * cam_list;
 
   dc1394_t * dc1394_instance;
@@ -344,6 +346,8 @@ protected:
   dc1394video_mode_t dcformat;
   dc1394featureset_t features;
   dc1394video_frame_t * frame;
+  //dequeued frames which are only enqueued again once their lease ends
+  std::vector<dc1394video_frame_t *> leased_frames;
   //dc1394camera_t **cameras;
   dc1394camera_t * camera;
 
@@ -404,6 +408,9 @@ public:
   void writeAllParameterValues();
 
   virtual bool copyAndConvertFrame(const RawImage & src, RawImage & target);
+  virtual bool setLeaseCount(int count);
+  virtual bool leaseFrame(const RawImage & src, RawImage & target);
+  virtual void releaseLease(const RawImage & leased);
 
   virtual string getCaptureMethodName() const;
 
@@ -246,6 +246,26 @@ bool CaptureFromFile::copyAndConvertFrame(const RawImage & src, RawImage & targe
   return true;
 }
 
+bool CaptureFromFile::setLeaseCount(int count)
+{
+  (void)count;
+  // the preloaded images are never overwritten, so any number of them can be leased
+  return true;
+}
+
+bool CaptureFromFile::leaseFrame(const RawImage & src, RawImage & target)
+{
+  mutex.lock();
+  ColorFormat output_fmt = Colors::stringToColorFormat(v_colorout->getSelection().c_str());
+  // the preloaded images stay valid for the lifetime of this capture module
+  bool res = (output_fmt == src.getColorFormat() && src.getData() != nullptr);
+  if (res) {
+    target.lease(src);
+  }
+  mutex.unlock();
+  return res;
+}
+
 RawImage CaptureFromFile::getFrame()
 {
    mutex.lock();
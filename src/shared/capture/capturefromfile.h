@@ -80,6 +80,8 @@ public:
   void cleanup();
 
   virtual bool copyAndConvertFrame(const RawImage & src, RawImage & target);
+  virtual bool setLeaseCount(int count);
+  virtual bool leaseFrame(const RawImage & src, RawImage & target);
   virtual string getCaptureMethodName() const;
 };
 
@@ -53,3 +53,17 @@ bool CaptureInterface::copyAndConvertFrame(const RawImage & src, RawImage & targ
   memcpy(target.getData(),src.getData(),src.getNumBytes());
   return true;
 }
+
+bool CaptureInterface::setLeaseCount(int count) {
+  return count == 0;
+}
+
+bool CaptureInterface::leaseFrame(const RawImage & src, RawImage & target) {
+  (void)src;
+  (void)target;
+  return false;
+}
+
+void CaptureInterface::releaseLease(const RawImage & leased) {
+  (void)leased;
+}
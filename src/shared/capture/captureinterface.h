@@ -102,6 +102,32 @@ public:
     /// already allocated, and then memcpy the data as-is.
     virtual bool     copyAndConvertFrame(const RawImage & src, RawImage & target);
 
+    /// Asks the driver to let up to \p count frames be leased at the same
+    /// time (see leaseFrame()), e.g. by allocating that many buffers in
+    /// addition to its own. It is called before startCapture().
+    /// Returns false if the driver can not hold that many leases, in which
+    /// case frames have to be copied with copyAndConvertFrame().
+    /// The base implementation only accepts a count of 0.
+    virtual bool     setLeaseCount(int count);
+
+    /// This function lets \p target reference the buffer of \p src
+    /// directly, instead of copying it with copyAndConvertFrame().
+    /// This is only possible if \p src already has the color format
+    /// copyAndConvertFrame() would produce, and while fewer frames than
+    /// the count passed to setLeaseCount() are leased.
+    /// The buffer then belongs to the lease: releaseFrame() does not hand
+    /// it back to the driver, it stays valid until releaseLease() is called
+    /// with \p target. All leases have to end before stopCapture().
+    ///
+    /// Returns false if the frame has to be copied instead. The base
+    /// implementation never leases, as it does not know the lifetime of
+    /// the driver buffers.
+    virtual bool     leaseFrame(const RawImage & src, RawImage & target);
+
+    /// Hands the buffer referenced by \p leased, which was leased with
+    /// leaseFrame(), back to the driver.
+    virtual void     releaseLease(const RawImage & leased);
+
     /// Return a string describing your capture method
     /// e.g. DC1394B, or GigEVision, or V4LCapture, or USBCam,...
     virtual string   getCaptureMethodName() const = 0;
@@ -0,0 +1,100 @@
+//========================================================================
+//  This software is free: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License Version 3,
+//  as published by the Free Software Foundation.
+//
+//  This software is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  Version 3 in the file COPYING that came with this distribution.
+//  If not, see <http://www.gnu.org/licenses/>.
+//========================================================================
+/*!
+  \file    leasable_frames.h
+  \brief   C++ Interface: LeasableFrames
+*/
+//========================================================================
+
+#ifndef LEASABLE_FRAMES_H
+#define LEASABLE_FRAMES_H
+
+#include "rawimage.h"
+#include <vector>
+
+/*!
+  \class   LeasableFrames
+  \brief   The output buffers of a capture module which produces its frames itself
+
+  Capture modules which convert or generate frames into buffers of their own
+  keep one buffer per lease (see CaptureInterface::setLeaseCount()) and one
+  more here, so that the next frame is always produced in a buffer which is
+  not leased.
+*/
+class LeasableFrames {
+  std::vector<RawImage> frames;
+  std::vector<bool> leased;
+  int current;
+  int num_leased;
+public:
+  LeasableFrames() : frames(1), leased(1, false), current(0), num_leased(0) {}
+
+  ~LeasableFrames() {
+    for (RawImage & frame : frames) {
+      frame.clear();
+    }
+  }
+
+  /// keeps buffers for \p count leases. Must not be called while frames are leased.
+  void setLeaseCount(int count) {
+    for (RawImage & frame : frames) {
+      frame.clear();
+    }
+    frames.assign(count + 1, RawImage());
+    leased.assign(count + 1, false);
+    current=0;
+    num_leased=0;
+  }
+
+  /// the buffer to produce the next frame in, which is not leased
+  RawImage & next() {
+    for (size_t i=0;i<frames.size() && leased[current];i++) {
+      current=(current + 1) % frames.size();
+    }
+    return frames[current];
+  }
+
+  /// the buffer of the most recent frame
+  RawImage & last() {
+    return frames[current];
+  }
+
+  /// lets \p target reference \p src, one of the buffers. Fails if it is
+  /// not one of them, or if this would lease the last free buffer.
+  bool lease(const RawImage & src, RawImage & target) {
+    if (src.getData() == nullptr || num_leased + 1 >= (int)frames.size()) return false;
+    for (size_t i=0;i<frames.size();i++) {
+      if (frames[i].getData() == src.getData() && !leased[i]) {
+        leased[i]=true;
+        num_leased++;
+        target.lease(src);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /// ends the lease of the buffer referenced by \p image
+  void release(const RawImage & image) {
+    for (size_t i=0;i<frames.size();i++) {
+      if (leased[i] && frames[i].getData() == image.getData()) {
+        leased[i]=false;
+        num_leased--;
+      }
+    }
+  }
+};
+
+#endif
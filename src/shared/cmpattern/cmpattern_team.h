@@ -120,6 +120,9 @@ public:
 
     ~RobotPattern();
 
+    /// whether the robot detection reads the thresholded image
+    bool isHistogramEnabled() const { return _histogram_enable->getBool(); }
+
 };
 
 }
@@ -367,8 +367,9 @@ SSL_DetectionRobot * TeamDetector::addRobot(::google::protobuf::RepeatedPtrField
         robots->Add();
         size++;
       }
+      //moves the pointers only, the last item ends up at i and is reused
       for (int j=size-1; j>i; j--) {
-        (*(robots->Mutable(j)))=robots->Get(j-1);
+        robots->SwapElements(j, j-1);
       }
       result_robot = robots->Mutable(i);
       result_robot->Clear();
@@ -392,8 +393,8 @@ void TeamDetector::stripRobots(::google::protobuf::RepeatedPtrField< ::SSL_Detec
   for (int src=0;src<size;src++) {
     if (robots->Get(src).confidence() != 0.0) {
       if (tgt!=src) {
-        //copy operation is needed:
-        (*(robots->Mutable(tgt)))=robots->Get(src);
+        //the discarded item at tgt is moved to the end, where it is removed below
+        robots->SwapElements(tgt, src);
       }
       tgt++;
     }
@@ -39,6 +39,8 @@ int Histogram::addBox(const Image<raw8> * image, int x1, int y1, int x2, int y2)
   raw8 * data = image->getPixelData();
   int image_width = image->getWidth();
   int image_height = image->getHeight();
+  //e.g. the empty thresholded image of fused mode
+  if (image_width <= 0 || image_height <= 0) return 0;
 
   x1 = bound(x1,0,image_width-1);
   y1 = bound(y1,0,image_height-1);
@@ -21,6 +21,79 @@
 */
 //========================================================================
 #include "cmvision_region.h"
+#include "simd_dispatch.h"
+#include <algorithm>
+#ifdef SIMD_DISPATCH_X86
+#include <x86intrin.h>
+#endif
+
+// Run end search for encodeRuns: returns the first position in (x, width]
+// whose label differs from row[x], or width. Most runs in a thresholded
+// image are either very short (noise at color borders) or very long
+// (background), so the first few pixels are compared one by one before
+// switching to full vectors.
+typedef int (*RunEndKernel)(const unsigned char * row, int x, int width);
+
+static const int RunEndScalarSteps = 8;
+
+static inline int findRunEndShort(const unsigned char * row, int & x, int width) {
+  const unsigned char m=row[x];
+  int stop=x + RunEndScalarSteps < width ? x + RunEndScalarSteps : width;
+  x++;
+  while(x != stop && row[x] == m) x++;
+  return m;
+}
+
+static int findRunEnd_Scalar(const unsigned char * row, int x, int width) {
+  const unsigned char m=row[x];
+  while(x != width && row[x] == m) x++;
+  return x;
+}
+
+#ifdef SIMD_DISPATCH_X86
+SIMD_TARGET("sse4.1")
+static int findRunEnd_SSE41(const unsigned char * row, int x, int width) {
+  const int m=findRunEndShort(row, x, width);
+  if (x == width || row[x] != m) return x;
+  const __m128i label=_mm_set1_epi8((char)m);
+  for (; x + 16 <= width; x+=16) {
+    unsigned int same=_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(row + x)), label));
+    if (same != 0xFFFF) return x + __builtin_ctz(~same);
+  }
+  while(x != width && row[x] == m) x++;
+  return x;
+}
+
+SIMD_TARGET("avx2")
+static int findRunEnd_AVX2(const unsigned char * row, int x, int width) {
+  const int m=findRunEndShort(row, x, width);
+  if (x == width || row[x] != m) return x;
+  const __m256i label=_mm256_set1_epi8((char)m);
+  for (; x + 32 <= width; x+=32) {
+    unsigned int same=_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(row + x)), label));
+    if (same != 0xFFFFFFFFu) return x + __builtin_ctz(~same);
+  }
+  while(x != width && row[x] == m) x++;
+  return x;
+}
+
+SIMD_TARGET("avx512f,avx512bw")
+static int findRunEnd_AVX512(const unsigned char * row, int x, int width) {
+  const int m=findRunEndShort(row, x, width);
+  if (x == width || row[x] != m) return x;
+  const __m512i label=_mm512_set1_epi8((char)m);
+  for (; x + 64 <= width; x+=64) {
+    __mmask64 differs=_mm512_cmpneq_epi8_mask(_mm512_loadu_si512((const void*)(row + x)), label);
+    if (differs != 0) return x + __builtin_ctzll(differs);
+  }
+  while(x != width && row[x] == m) x++;
+  return x;
+}
+
+static const SimdKernel<RunEndKernel> find_run_end(findRunEnd_Scalar, findRunEnd_SSE41, findRunEnd_AVX2, findRunEnd_AVX512);
+#else
+static const SimdKernel<RunEndKernel> find_run_end(findRunEnd_Scalar, nullptr, nullptr, nullptr);
+#endif
 
 namespace CMVision {
 
@@ -34,61 +107,89 @@ RegionProcessing::~RegionProcessing()
 }
 
 
-void RegionProcessing::encodeRuns(Image<raw8> * tmap, CMVision::RunList * runlist)
+void RegionProcessing::encodeRuns(Image<raw8> * tmap, CMVision::RunList * runlist, const MaskSpans * spans)
 // Changes the flat array version of the thresholded image into a run
 // length encoded version, which speeds up later processing since we
 // only have to look at the points where values change.
 {
+  runlist->setUsedRuns(encodeRows(tmap->getPixelData(), tmap->getWidth(), 0, tmap->getHeight(), runlist, 0, spans));
+}
 
+int RegionProcessing::encodeRows(const raw8 * rows, int width, int first_row, int num_rows,
+                                 CMVision::RunList * runlist, int used_runs, const MaskSpans * spans)
+{
   int max_runs = runlist->getMaxRuns();
   CMVision::Run * runs = runlist->getRunArrayPointer();
-  raw8 * map = tmap->getPixelData();
-  int width=tmap->getWidth();
-  int height=tmap->getHeight();
-
+  const RunEndKernel runEnd = find_run_end.get();
 
   raw8 clear(0);
   raw8 m;
-  raw8 *row;
+  const raw8 *row;
   int x,y,j,l;
   CMVision::Run r;
 
   r.next = 0;
 
-  j = 0;
-  for(y=0; y<height; y++){
-    row = &map[y * width];
-
-    r.y = y;
+  if (spans != nullptr && (int)spans->size() < first_row + num_rows) spans=nullptr;
+  RowSpans whole_row(1);
+  whole_row[0].begin = 0;
+  whole_row[0].end = width;
 
-    x = 0;
-    while(x < width){
-      m = row[x];
-      r.x = x;
+  j = used_runs;
+  if (j >= max_runs) return j;
+  for(y=0; y<num_rows; y++){
+    row = &rows[y * width];
 
-      l = x;
+    r.y = first_row + y;
 
-      //fix by Stefan: stop if x==row-width
-      //(and don't access the row array in that case as it could cause a segfault)
-      //Note that the left argument of the && operator is always evaluated first and as
-      //such this expression should be safe.
-      while(x != width && row[x] == m) x++;
-
-      if(m != clear || x==width) {
+    //only the spans of the row are scanned, the pixels outside them are clear.
+    //the runs are the same as when scanning the whole row: clear runs are
+    //skipped, except for the one reaching the end of the row.
+    const int row_first_run = j;
+    int clear_start = 0;
+    x = 0;
+    for (const MaskSpan & span : (spans != nullptr) ? (*spans)[first_row + y] : whole_row) {
+      int end = std::min(span.end, width);
+      x = std::max(x, span.begin);
+      while(x < end){
+        m = row[x];
+        l = x;
+        //the kernels never access the row beyond width
+        x = runEnd((const unsigned char *)row, x, end);
+        if (m == clear) continue;
+        clear_start = x;
+
+        //a run which the previous span ended
+        if (j > row_first_run && runs[j-1].color == m && runs[j-1].x + runs[j-1].width == l) {
+          runs[j-1].width = x - runs[j-1].x;
+          continue;
+        }
+        r.x = l;
         r.color = m;
         r.width = x - l;
         r.parent = j;
         runs[j++] = r;
 
         if(j >= max_runs){
-          runlist->setUsedRuns(j);
-          return;
+          return j;
         }
       }
     }
+    if (clear_start < width) {
+      //the clear rest of the row (or the whole row if it has no spans)
+      r.x = clear_start;
+      r.color = clear;
+      r.width = width - r.x;
+      r.parent = j;
+      runs[j++] = r;
+
+      if(j >= max_runs){
+        return j;
+      }
+    }
   }
 
-  runlist->setUsedRuns(j);
+  return j;
 }
 
 
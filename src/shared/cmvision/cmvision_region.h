@@ -26,6 +26,7 @@
 #include "geometry.h"
 #include "nkdtree.h"
 #include "cmvision_threshold.h"
+#include "mask_spans.h"
 #include "lut3d.h"
 
 namespace CMVision {
@@ -292,7 +293,14 @@ public:
 
     ~RegionProcessing();
 
-    static void encodeRuns(Image<raw8> * tmap, CMVision::RunList * runlist);
+    /// given the \p spans of the image mask, only the pixels inside them are scanned
+    static void encodeRuns(Image<raw8> * tmap, CMVision::RunList * runlist, const MaskSpans * spans = nullptr);
+    /// appends the runs of \p num_rows rows of thresholded pixels, starting at image row
+    /// \p first_row, to the \p used_runs runs already in \p runlist. Used to encode an image
+    /// tile by tile. Returns the number of runs used afterwards, which is the maximum
+    /// number of runs if the runlist is full. \p spans are indexed by image row.
+    static int encodeRows(const raw8 * rows, int width, int first_row, int num_rows,
+                          CMVision::RunList * runlist, int used_runs, const MaskSpans * spans = nullptr);
     static void connectComponents(CMVision::RunList * runlist);
     static void extractRegions(CMVision::RegionList * reglist, CMVision::RunList * runlist);
     //returns the max area found:
@@ -20,10 +20,421 @@
 */
 //========================================================================
 #include "cmvision_threshold.h"
-#ifdef __AVX2__
+#include "simd_dispatch.h"
+#include "conversions.h"
+#include <string.h>
+#include <algorithm>
+#ifdef SIMD_DISPATCH_X86
 #include <x86intrin.h>
 #endif
 
+/// the LUT geometry, copied out of the LUT once per image
+struct ThresholdParams {
+  const lut_mask_t * LUT;
+  int X_SHIFT;
+  int Y_SHIFT;
+  int Z_SHIFT;
+  int Z_AND_Y_BITS;
+  int Z_BITS;
+  template <class L> explicit ThresholdParams(const L * lut) {
+    LUT=lut->getTable();
+    X_SHIFT=lut->X_SHIFT;
+    Y_SHIFT=lut->Y_SHIFT;
+    Z_SHIFT=lut->Z_SHIFT;
+    Z_AND_Y_BITS=lut->Z_AND_Y_BITS;
+    Z_BITS=lut->Z_BITS;
+  }
+};
+
+// Every kernel thresholds the pixels [first, last). The SIMD variants leave
+// the remainder which does not fill a whole vector iteration to the scalar one.
+typedef void (*ThresholdUYVYKernel)(const uyvy * source, raw8 * target, const unsigned char * mask,
+                                    unsigned int first, unsigned int last, const ThresholdParams & p);
+typedef void (*ThresholdYUV444Kernel)(const yuv * source, raw8 * target, const unsigned char * mask,
+                                      unsigned int first, unsigned int last, const ThresholdParams & p);
+typedef void (*ThresholdRGBKernel)(const rgb * source, raw8 * target, const unsigned char * mask,
+                                   unsigned int first, unsigned int last, const ThresholdParams & p);
+
+static void thresholdUYVY_Scalar(const uyvy * source, raw8 * target, const unsigned char * mask,
+                                 unsigned int first, unsigned int last, const ThresholdParams & p) {
+  const lut_mask_t * LUT=p.LUT;
+  for (unsigned int i=first;i<last;i+=2) {
+    uyvy px=source[(i >> 0x01)];
+    int B=((px.u >> p.Y_SHIFT) << p.Z_BITS);
+    int C=(px.v >> p.Z_SHIFT);
+    target[i] =  mask[i] & LUT[(((px.y1 >> p.X_SHIFT) << p.Z_AND_Y_BITS) | B | C)];
+    target[i+1] =  mask[i+1] & LUT[(((px.y2 >> p.X_SHIFT) << p.Z_AND_Y_BITS) | B | C)];
+  }
+}
+
+static void thresholdYUV444_Scalar(const yuv * source, raw8 * target, const unsigned char * mask,
+                                   unsigned int first, unsigned int last, const ThresholdParams & p) {
+  const lut_mask_t * LUT=p.LUT;
+  for (unsigned int i=first;i<last;i++) {
+    yuv px=source[i];
+    target[i] =  mask[i] & LUT[(((px.y >> p.X_SHIFT) << p.Z_AND_Y_BITS) | ((px.u >> p.Y_SHIFT) << p.Z_BITS) | (px.v >> p.Z_SHIFT))];
+  }
+}
+
+static void thresholdRGB_Scalar(const rgb * source, raw8 * target, const unsigned char * mask,
+                                unsigned int first, unsigned int last, const ThresholdParams & p) {
+  const lut_mask_t * LUT=p.LUT;
+  #pragma GCC unroll 4
+  for (unsigned int i=first; i<last; i++) {
+    rgb px=source[i];
+    target[i] = mask[i] & LUT[(((px.r >> p.X_SHIFT) << p.Z_AND_Y_BITS) | ((px.g >> p.Y_SHIFT) << p.Z_BITS) | (px.b >> p.Z_SHIFT))];
+  }
+}
+
+#ifdef SIMD_DISPATCH_X86
+// The gather kernels load 32 bit from LUT + index. LUT3D allocates twice the
+// addressable size, so reading 3 bytes beyond the largest index stays in bounds.
+
+SIMD_TARGET("sse4.1")
+static void thresholdUYVY_SSE41(const uyvy * source, raw8 * target, const unsigned char * mask,
+                                unsigned int first, unsigned int last, const ThresholdParams & p) {
+  const __m128i byte_mask = _mm_set1_epi32(0xFF);
+  const __m128i x_shift = _mm_cvtsi32_si128(p.X_SHIFT);
+  const __m128i y_shift = _mm_cvtsi32_si128(p.Y_SHIFT);
+  const __m128i z_shift = _mm_cvtsi32_si128(p.Z_SHIFT);
+  const __m128i z_and_y_bits = _mm_cvtsi32_si128(p.Z_AND_Y_BITS);
+  const __m128i z_bits = _mm_cvtsi32_si128(p.Z_BITS);
+  const lut_mask_t * LUT=p.LUT;
+  alignas(16) uint32_t idx1[4];
+  alignas(16) uint32_t idx2[4];
+
+  unsigned int i=first;
+  //no gathers: the indices of 8 pixels are computed in vector registers, the lookups are scalar
+  for (; i + 8 <= last; i+=8) {
+    const __m128i mp = _mm_loadu_si128((const __m128i*)(source + i/2));
+    const __m128i u  = _mm_and_si128(mp, byte_mask);
+    const __m128i y1 = _mm_and_si128(_mm_srli_epi32(mp, 8), byte_mask);
+    const __m128i v  = _mm_and_si128(_mm_srli_epi32(mp, 16), byte_mask);
+    const __m128i y2 = _mm_srli_epi32(mp, 24);
+    const __m128i uv = _mm_or_si128(_mm_sll_epi32(_mm_srl_epi32(u, y_shift), z_bits), _mm_srl_epi32(v, z_shift));
+    _mm_store_si128((__m128i*)idx1, _mm_or_si128(_mm_sll_epi32(_mm_srl_epi32(y1, x_shift), z_and_y_bits), uv));
+    _mm_store_si128((__m128i*)idx2, _mm_or_si128(_mm_sll_epi32(_mm_srl_epi32(y2, x_shift), z_and_y_bits), uv));
+    for (int k=0;k<4;k++) {
+      target[i+2*k] = mask[i+2*k] & LUT[idx1[k]];
+      target[i+2*k+1] = mask[i+2*k+1] & LUT[idx2[k]];
+    }
+  }
+  thresholdUYVY_Scalar(source, target, mask, i, last, p);
+}
+
+SIMD_TARGET("avx2")
+static void thresholdUYVY_AVX2(const uyvy * source, raw8 * target, const unsigned char * mask,
+                               unsigned int first, unsigned int last, const ThresholdParams & p) {
+  const __m256i byte_mask = _mm256_set1_epi32(0xFF);
+  const __m128i x_shift = _mm_cvtsi32_si128(p.X_SHIFT);
+  const __m128i y_shift = _mm_cvtsi32_si128(p.Y_SHIFT);
+  const __m128i z_shift = _mm_cvtsi32_si128(p.Z_SHIFT);
+  const __m128i z_and_y_bits = _mm_cvtsi32_si128(p.Z_AND_Y_BITS);
+  const __m128i z_bits = _mm_cvtsi32_si128(p.Z_BITS);
+  const int * table = (const int *)p.LUT;
+
+  unsigned int i=first;
+  for (; i + 32 <= last; i+=32) {
+    __m256i words[2];
+    //each 32 bit lane holds one macropixel: u | y1 << 8 | v << 16 | y2 << 24
+    for (int k=0;k<2;k++) {
+      const __m256i mp = _mm256_loadu_si256((const __m256i*)(source + i/2 + 8*k));
+      const __m256i u  = _mm256_and_si256(mp, byte_mask);
+      const __m256i y1 = _mm256_and_si256(_mm256_srli_epi32(mp, 8), byte_mask);
+      const __m256i v  = _mm256_and_si256(_mm256_srli_epi32(mp, 16), byte_mask);
+      const __m256i y2 = _mm256_srli_epi32(mp, 24);
+      const __m256i uv = _mm256_or_si256(_mm256_sll_epi32(_mm256_srl_epi32(u, y_shift), z_bits), _mm256_srl_epi32(v, z_shift));
+      const __m256i idx1 = _mm256_or_si256(_mm256_sll_epi32(_mm256_srl_epi32(y1, x_shift), z_and_y_bits), uv);
+      const __m256i idx2 = _mm256_or_si256(_mm256_sll_epi32(_mm256_srl_epi32(y2, x_shift), z_and_y_bits), uv);
+      const __m256i c1 = _mm256_and_si256(_mm256_i32gather_epi32(table, idx1, 1), byte_mask);
+      const __m256i c2 = _mm256_and_si256(_mm256_i32gather_epi32(table, idx2, 1), byte_mask);
+      //both pixels of a macropixel as one 16 bit word
+      words[k] = _mm256_or_si256(c1, _mm256_slli_epi32(c2, 8));
+    }
+    //packing works within 128 bit lanes, the permutation restores the pixel order
+    __m256i labels = _mm256_permute4x64_epi64(_mm256_packus_epi32(words[0], words[1]), _MM_SHUFFLE(3, 1, 2, 0));
+    labels = _mm256_and_si256(labels, _mm256_loadu_si256((const __m256i*)(mask + i)));
+    _mm256_storeu_si256((__m256i*)(target + i), labels);
+  }
+  thresholdUYVY_Scalar(source, target, mask, i, last, p);
+}
+
+//GCC 12 implements the unmasked AVX-512 intrinsics by merging into an undefined
+//register, which -Wmaybe-uninitialized reports. The AVX-512 kernels use the
+//zero-masking forms on all lanes instead, which compile to the same instructions.
+static const __mmask16 all_lanes = 0xFFFF;
+
+SIMD_TARGET("avx512f,avx512bw")
+static void thresholdUYVY_AVX512(const uyvy * source, raw8 * target, const unsigned char * mask,
+                                 unsigned int first, unsigned int last, const ThresholdParams & p) {
+  const __m512i byte_mask = _mm512_set1_epi32(0xFF);
+  const __m128i x_shift = _mm_cvtsi32_si128(p.X_SHIFT);
+  const __m128i y_shift = _mm_cvtsi32_si128(p.Y_SHIFT);
+  const __m128i z_shift = _mm_cvtsi32_si128(p.Z_SHIFT);
+  const __m128i z_and_y_bits = _mm_cvtsi32_si128(p.Z_AND_Y_BITS);
+  const __m128i z_bits = _mm_cvtsi32_si128(p.Z_BITS);
+  const int * table = (const int *)p.LUT;
+
+  unsigned int i=first;
+  for (; i + 32 <= last; i+=32) {
+    const __m512i mp = _mm512_loadu_si512((const void*)(source + i/2));
+    const __m512i u  = _mm512_and_si512(mp, byte_mask);
+    const __m512i y1 = _mm512_and_si512(_mm512_maskz_srli_epi32(all_lanes, mp, 8), byte_mask);
+    const __m512i v  = _mm512_and_si512(_mm512_maskz_srli_epi32(all_lanes, mp, 16), byte_mask);
+    const __m512i y2 = _mm512_maskz_srli_epi32(all_lanes, mp, 24);
+    const __m512i uv = _mm512_or_si512(_mm512_maskz_sll_epi32(all_lanes, _mm512_maskz_srl_epi32(all_lanes, u, y_shift), z_bits), _mm512_maskz_srl_epi32(all_lanes, v, z_shift));
+    const __m512i idx1 = _mm512_or_si512(_mm512_maskz_sll_epi32(all_lanes, _mm512_maskz_srl_epi32(all_lanes, y1, x_shift), z_and_y_bits), uv);
+    const __m512i idx2 = _mm512_or_si512(_mm512_maskz_sll_epi32(all_lanes, _mm512_maskz_srl_epi32(all_lanes, y2, x_shift), z_and_y_bits), uv);
+    const __m512i c1 = _mm512_and_si512(_mm512_mask_i32gather_epi32(_mm512_setzero_si512(), all_lanes, idx1, table, 1), byte_mask);
+    const __m512i c2 = _mm512_and_si512(_mm512_mask_i32gather_epi32(_mm512_setzero_si512(), all_lanes, idx2, table, 1), byte_mask);
+    //both pixels of a macropixel as one 16 bit word, narrowing keeps the order
+    __m256i labels = _mm512_maskz_cvtepi32_epi16(all_lanes, _mm512_or_si512(c1, _mm512_maskz_slli_epi32(all_lanes, c2, 8)));
+    labels = _mm256_and_si256(labels, _mm256_loadu_si256((const __m256i*)(mask + i)));
+    _mm256_storeu_si256((__m256i*)(target + i), labels);
+  }
+  thresholdUYVY_Scalar(source, target, mask, i, last, p);
+}
+
+SIMD_TARGET("sse4.1")
+static void thresholdYUV444_SSE41(const yuv * source, raw8 * target, const unsigned char * mask,
+                                  unsigned int first, unsigned int last, const ThresholdParams & p) {
+  const __m128i byte_mask = _mm_set1_epi32(0xFF);
+  const __m128i spread = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+  const __m128i x_shift = _mm_cvtsi32_si128(p.X_SHIFT);
+  const __m128i y_shift = _mm_cvtsi32_si128(p.Y_SHIFT);
+  const __m128i z_shift = _mm_cvtsi32_si128(p.Z_SHIFT);
+  const __m128i z_and_y_bits = _mm_cvtsi32_si128(p.Z_AND_Y_BITS);
+  const __m128i z_bits = _mm_cvtsi32_si128(p.Z_BITS);
+  const lut_mask_t * LUT=p.LUT;
+  const unsigned char * bytes = (const unsigned char *)source;
+  alignas(16) uint32_t idx[4];
+
+  unsigned int i=first;
+  //each load reads 4 bytes beyond its 4 pixels
+  for (; i + 6 <= last; i+=4) {
+    const __m128i px = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(bytes + 3*i)), spread);
+    const __m128i y = _mm_and_si128(px, byte_mask);
+    const __m128i u = _mm_and_si128(_mm_srli_epi32(px, 8), byte_mask);
+    const __m128i v = _mm_srli_epi32(px, 16);
+    _mm_store_si128((__m128i*)idx, _mm_or_si128(_mm_or_si128(_mm_sll_epi32(_mm_srl_epi32(y, x_shift), z_and_y_bits),
+                                                             _mm_sll_epi32(_mm_srl_epi32(u, y_shift), z_bits)),
+                                                _mm_srl_epi32(v, z_shift)));
+    for (int k=0;k<4;k++) {
+      target[i+k] = mask[i+k] & LUT[idx[k]];
+    }
+  }
+  thresholdYUV444_Scalar(source, target, mask, i, last, p);
+}
+
+SIMD_TARGET("avx2")
+static void thresholdYUV444_AVX2(const yuv * source, raw8 * target, const unsigned char * mask,
+                                 unsigned int first, unsigned int last, const ThresholdParams & p) {
+  const __m256i byte_mask = _mm256_set1_epi32(0xFF);
+  //spreads 4 packed pixels of each 128 bit lane to one pixel per 32 bit lane
+  const __m256i spread = _mm256_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1,
+                                          0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+  const __m256i restore_order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+  const __m128i x_shift = _mm_cvtsi32_si128(p.X_SHIFT);
+  const __m128i y_shift = _mm_cvtsi32_si128(p.Y_SHIFT);
+  const __m128i z_shift = _mm_cvtsi32_si128(p.Z_SHIFT);
+  const __m128i z_and_y_bits = _mm_cvtsi32_si128(p.Z_AND_Y_BITS);
+  const __m128i z_bits = _mm_cvtsi32_si128(p.Z_BITS);
+  const int * table = (const int *)p.LUT;
+  const unsigned char * bytes = (const unsigned char *)source;
+
+  unsigned int i=first;
+  //the last load of an iteration reads 4 bytes beyond its 32 pixels
+  for (; i + 34 <= last; i+=32) {
+    __m256i labels[4];
+    for (int k=0;k<4;k++) {
+      const unsigned char * b = bytes + 3*(i + 8*k);
+      const __m256i packed = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)b)),
+                                                     _mm_loadu_si128((const __m128i*)(b + 12)), 1);
+      //each 32 bit lane holds one pixel: y | u << 8 | v << 16
+      const __m256i px = _mm256_shuffle_epi8(packed, spread);
+      const __m256i y = _mm256_and_si256(px, byte_mask);
+      const __m256i u = _mm256_and_si256(_mm256_srli_epi32(px, 8), byte_mask);
+      const __m256i v = _mm256_srli_epi32(px, 16);
+      const __m256i idx = _mm256_or_si256(_mm256_or_si256(_mm256_sll_epi32(_mm256_srl_epi32(y, x_shift), z_and_y_bits),
+                                                          _mm256_sll_epi32(_mm256_srl_epi32(u, y_shift), z_bits)),
+                                          _mm256_srl_epi32(v, z_shift));
+      labels[k] = _mm256_and_si256(_mm256_i32gather_epi32(table, idx, 1), byte_mask);
+    }
+    //packing works within 128 bit lanes, the permutation restores the pixel order
+    __m256i result = _mm256_packus_epi16(_mm256_packus_epi32(labels[0], labels[1]), _mm256_packus_epi32(labels[2], labels[3]));
+    result = _mm256_permutevar8x32_epi32(result, restore_order);
+    result = _mm256_and_si256(result, _mm256_loadu_si256((const __m256i*)(mask + i)));
+    _mm256_storeu_si256((__m256i*)(target + i), result);
+  }
+  thresholdYUV444_Scalar(source, target, mask, i, last, p);
+}
+
+SIMD_TARGET("avx512f,avx512bw")
+static void thresholdYUV444_AVX512(const yuv * source, raw8 * target, const unsigned char * mask,
+                                   unsigned int first, unsigned int last, const ThresholdParams & p) {
+  const __m512i byte_mask = _mm512_set1_epi32(0xFF);
+  //spreads 4 packed pixels of each 128 bit lane to one pixel per 32 bit lane
+  const __m512i spread = _mm512_maskz_broadcast_i32x4(all_lanes, _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1));
+  const __m128i x_shift = _mm_cvtsi32_si128(p.X_SHIFT);
+  const __m128i y_shift = _mm_cvtsi32_si128(p.Y_SHIFT);
+  const __m128i z_shift = _mm_cvtsi32_si128(p.Z_SHIFT);
+  const __m128i z_and_y_bits = _mm_cvtsi32_si128(p.Z_AND_Y_BITS);
+  const __m128i z_bits = _mm_cvtsi32_si128(p.Z_BITS);
+  const int * table = (const int *)p.LUT;
+  const unsigned char * bytes = (const unsigned char *)source;
+
+  unsigned int i=first;
+  //the last load of an iteration reads 4 bytes beyond its 32 pixels
+  for (; i + 34 <= last; i+=32) {
+    __m128i labels[2];
+    for (int k=0;k<2;k++) {
+      const unsigned char * b = bytes + 3*(i + 16*k);
+      __m512i packed = _mm512_castsi128_si512(_mm_loadu_si128((const __m128i*)b));
+      packed = _mm512_inserti32x4(packed, _mm_loadu_si128((const __m128i*)(b + 12)), 1);
+      packed = _mm512_inserti32x4(packed, _mm_loadu_si128((const __m128i*)(b + 24)), 2);
+      packed = _mm512_inserti32x4(packed, _mm_loadu_si128((const __m128i*)(b + 36)), 3);
+      //each 32 bit lane holds one pixel: y | u << 8 | v << 16
+      const __m512i px = _mm512_shuffle_epi8(packed, spread);
+      const __m512i y = _mm512_and_si512(px, byte_mask);
+      const __m512i u = _mm512_and_si512(_mm512_maskz_srli_epi32(all_lanes, px, 8), byte_mask);
+      const __m512i v = _mm512_maskz_srli_epi32(all_lanes, px, 16);
+      const __m512i idx = _mm512_or_si512(_mm512_or_si512(_mm512_maskz_sll_epi32(all_lanes, _mm512_maskz_srl_epi32(all_lanes, y, x_shift), z_and_y_bits),
+                                                          _mm512_maskz_sll_epi32(all_lanes, _mm512_maskz_srl_epi32(all_lanes, u, y_shift), z_bits)),
+                                          _mm512_maskz_srl_epi32(all_lanes, v, z_shift));
+      labels[k] = _mm512_maskz_cvtepi32_epi8(all_lanes, _mm512_mask_i32gather_epi32(_mm512_setzero_si512(), all_lanes, idx, table, 1));
+    }
+    __m256i result = _mm256_inserti128_si256(_mm256_castsi128_si256(labels[0]), labels[1], 1);
+    result = _mm256_and_si256(result, _mm256_loadu_si256((const __m256i*)(mask + i)));
+    _mm256_storeu_si256((__m256i*)(target + i), result);
+  }
+  thresholdYUV444_Scalar(source, target, mask, i, last, p);
+}
+
+SIMD_TARGET("sse4.1")
+static void thresholdRGB_SSE41(const rgb * source, raw8 * target, const unsigned char * mask,
+                               unsigned int first, unsigned int last, const ThresholdParams & p) {
+  // unpacking from: https://docs.google.com/presentation/d/1I0-SiHid1hTsv7tjLST2dYW5YF5AJVfs9l4Rg9rvz48/edit#slide=id.g1eefe20b_0_125
+  __m128i ssse3_red_indeces_0 = _mm_set_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 15, 12, 9, 6, 3, 0);
+  __m128i ssse3_red_indeces_1 = _mm_set_epi8(-1, -1, -1, -1, -1, 14, 11, 8, 5, 2, -1, -1, -1, -1, -1, -1);
+  __m128i ssse3_red_indeces_2 = _mm_set_epi8(13, 10, 7, 4, 1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+  __m128i ssse3_green_indeces_0 = _mm_set_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 13, 10, 7, 4, 1);
+  __m128i ssse3_green_indeces_1 = _mm_set_epi8(-1, -1, -1, -1, -1, 15, 12, 9, 6, 3, 0, -1, -1, -1, -1, -1);
+  __m128i ssse3_green_indeces_2 = _mm_set_epi8(14, 11, 8, 5, 2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+  __m128i ssse3_blue_indeces_0 = _mm_set_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 14, 11, 8, 5, 2);
+  __m128i ssse3_blue_indeces_1 = _mm_set_epi8(-1, -1, -1, -1, -1, -1, 13, 10, 7, 4, 1, -1, -1, -1, -1, -1);
+  __m128i ssse3_blue_indeces_2 = _mm_set_epi8(15, 12, 9, 6, 3, 0, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+  const __m128i x_shift = _mm_cvtsi32_si128(p.X_SHIFT);
+  const __m128i y_shift = _mm_cvtsi32_si128(p.Y_SHIFT);
+  const __m128i z_shift = _mm_cvtsi32_si128(p.Z_SHIFT);
+  const __m128i z_and_y_bits = _mm_cvtsi32_si128(p.Z_AND_Y_BITS);
+  const __m128i z_bits = _mm_cvtsi32_si128(p.Z_BITS);
+  const lut_mask_t * LUT=p.LUT;
+  alignas(16) uint16_t idx[16];
+
+  unsigned int i=first;
+  for (; i+16<=last; i+=16) {
+    const uint8_t * source_pixel = (const uint8_t*)(source + i);
+    const __m128i chunk0 = _mm_loadu_si128((const __m128i*)(source_pixel));
+    const __m128i chunk1 = _mm_loadu_si128((const __m128i*)(source_pixel + 16));
+    const __m128i chunk2 = _mm_loadu_si128((const __m128i*)(source_pixel + 32));
+
+    const __m128i red = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(chunk0, ssse3_red_indeces_0),
+                                                  _mm_shuffle_epi8(chunk1, ssse3_red_indeces_1)), _mm_shuffle_epi8(chunk2, ssse3_red_indeces_2));
+    const __m128i green = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(chunk0, ssse3_green_indeces_0),
+                                                    _mm_shuffle_epi8(chunk1, ssse3_green_indeces_1)), _mm_shuffle_epi8(chunk2, ssse3_green_indeces_2));
+    const __m128i blue = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(chunk0, ssse3_blue_indeces_0),
+                                                   _mm_shuffle_epi8(chunk1, ssse3_blue_indeces_1)), _mm_shuffle_epi8(chunk2, ssse3_blue_indeces_2));
+
+    // widen pixel values to 16bit, 8 at a time
+    for (int h=0;h<2;h++) {
+      const __m128i r = _mm_cvtepu8_epi16(h == 0 ? red : _mm_srli_si128(red, 8));
+      const __m128i g = _mm_cvtepu8_epi16(h == 0 ? green : _mm_srli_si128(green, 8));
+      const __m128i b = _mm_cvtepu8_epi16(h == 0 ? blue : _mm_srli_si128(blue, 8));
+      const __m128i rs = _mm_sll_epi16(_mm_srl_epi16(r, x_shift), z_and_y_bits);
+      const __m128i gs = _mm_sll_epi16(_mm_srl_epi16(g, y_shift), z_bits);
+      const __m128i bs = _mm_srl_epi16(b, z_shift);
+      _mm_store_si128((__m128i*)(idx + 8*h), _mm_or_si128(rs, _mm_or_si128(gs, bs)));
+    }
+
+    for(int j=0; j<16; j++) {
+      target[i+j] = mask[i+j] & LUT[idx[j]];
+    }
+  }
+  thresholdRGB_Scalar(source, target, mask, i, last, p);
+}
+
+SIMD_TARGET("avx2")
+static void thresholdRGB_AVX2(const rgb * source, raw8 * target, const unsigned char * mask,
+                              unsigned int first, unsigned int last, const ThresholdParams & p) {
+  // unpacking from: https://docs.google.com/presentation/d/1I0-SiHid1hTsv7tjLST2dYW5YF5AJVfs9l4Rg9rvz48/edit#slide=id.g1eefe20b_0_125
+  __m128i ssse3_red_indeces_0 = _mm_set_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 15, 12, 9, 6, 3, 0);
+  __m128i ssse3_red_indeces_1 = _mm_set_epi8(-1, -1, -1, -1, -1, 14, 11, 8, 5, 2, -1, -1, -1, -1, -1, -1);
+  __m128i ssse3_red_indeces_2 = _mm_set_epi8(13, 10, 7, 4, 1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+  __m128i ssse3_green_indeces_0 = _mm_set_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 13, 10, 7, 4, 1);
+  __m128i ssse3_green_indeces_1 = _mm_set_epi8(-1, -1, -1, -1, -1, 15, 12, 9, 6, 3, 0, -1, -1, -1, -1, -1);
+  __m128i ssse3_green_indeces_2 = _mm_set_epi8(14, 11, 8, 5, 2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+  __m128i ssse3_blue_indeces_0 = _mm_set_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 14, 11, 8, 5, 2);
+  __m128i ssse3_blue_indeces_1 = _mm_set_epi8(-1, -1, -1, -1, -1, -1, 13, 10, 7, 4, 1, -1, -1, -1, -1, -1);
+  __m128i ssse3_blue_indeces_2 = _mm_set_epi8(15, 12, 9, 6, 3, 0, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+  const lut_mask_t * LUT=p.LUT;
+
+  uint16_t idx[16];
+  unsigned int i=first;
+  for (; i+16<=last; i+=16) {
+    const uint8_t * source_pixel = (const uint8_t*)(source + i);
+
+    // crazy RGB unpacking
+    const __m128i chunk0 = _mm_loadu_si128((const __m128i*)(source_pixel));
+    const __m128i chunk1 = _mm_loadu_si128((const __m128i*)(source_pixel + 16));
+    const __m128i chunk2 = _mm_loadu_si128((const __m128i*)(source_pixel + 32));
+
+    const __m128i red = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(chunk0, ssse3_red_indeces_0),
+                                                  _mm_shuffle_epi8(chunk1, ssse3_red_indeces_1)), _mm_shuffle_epi8(chunk2, ssse3_red_indeces_2));
+    const __m128i green = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(chunk0, ssse3_green_indeces_0),
+                                                    _mm_shuffle_epi8(chunk1, ssse3_green_indeces_1)), _mm_shuffle_epi8(chunk2, ssse3_green_indeces_2));
+    const __m128i blue = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(chunk0, ssse3_blue_indeces_0),
+                                                   _mm_shuffle_epi8(chunk1, ssse3_blue_indeces_1)), _mm_shuffle_epi8(chunk2, ssse3_blue_indeces_2));
+
+    // widen pixel values to 16bit
+    __m256i r = _mm256_cvtepu8_epi16(red);
+    __m256i b = _mm256_cvtepu8_epi16(blue);
+    __m256i g = _mm256_cvtepu8_epi16(green);
+
+    // do the original shifts on 16 values in parallel
+    __m256i rs = _mm256_slli_epi16(_mm256_srli_epi16(r, p.X_SHIFT), p.Z_AND_Y_BITS);
+    __m256i gs = _mm256_slli_epi16(_mm256_srli_epi16(g, p.Y_SHIFT), p.Z_BITS);
+    __m256i bs = _mm256_srli_epi16(b, p.Z_SHIFT);
+
+    // construct LUT indices (ORing)
+    __m256i result = _mm256_or_si256(rs, _mm256_or_si256(gs, bs));
+
+    _mm256_storeu_si256((__m256i*)idx, result);
+
+#pragma GCC unroll 16
+    for(int j=0; j<16; j++) {
+      target[i+j] = mask[i+j] & LUT[idx[j]];
+    }
+  }
+  thresholdRGB_Scalar(source, target, mask, i, last, p);
+}
+
+static const SimdKernel<ThresholdUYVYKernel> threshold_uyvy(thresholdUYVY_Scalar, thresholdUYVY_SSE41, thresholdUYVY_AVX2, thresholdUYVY_AVX512);
+static const SimdKernel<ThresholdYUV444Kernel> threshold_yuv444(thresholdYUV444_Scalar, thresholdYUV444_SSE41, thresholdYUV444_AVX2, thresholdYUV444_AVX512);
+//RGB has no AVX-512 variant yet, the AVX2 one is used. The RGB variants compute
+//16 bit LUT indices, see rgbKernel().
+static const SimdKernel<ThresholdRGBKernel> threshold_rgb(thresholdRGB_Scalar, thresholdRGB_SSE41, thresholdRGB_AVX2, nullptr);
+#else
+static const SimdKernel<ThresholdUYVYKernel> threshold_uyvy(thresholdUYVY_Scalar, nullptr, nullptr, nullptr);
+static const SimdKernel<ThresholdYUV444Kernel> threshold_yuv444(thresholdYUV444_Scalar, nullptr, nullptr, nullptr);
+static const SimdKernel<ThresholdRGBKernel> threshold_rgb(thresholdRGB_Scalar, nullptr, nullptr, nullptr);
+#endif
+
+/// the RGB kernel for the LUT of \p p. LUTs with more than 16 index bits, i.e.
+/// more than the RGBLUT's default 5 bits per channel, take the scalar variant.
+static ThresholdRGBKernel rgbKernel(const ThresholdParams & p) {
+  return (8 - p.X_SHIFT) + p.Z_AND_Y_BITS <= 16 ? threshold_rgb.get() : thresholdRGB_Scalar;
+}
+
 CMVisionThreshold::CMVisionThreshold()
 {
 }
@@ -40,12 +451,10 @@ bool CMVisionThreshold::thresholdImageYUV422_UYVY(Image<raw8> * target, const Ra
     return false;
   }
 
-  register lut_mask_t * LUT = lut->getTable();
-
-  register unsigned int          target_size    = target->getNumPixels();
-  register uyvy *       source_pointer = (uyvy*)(source->getData());
-  register raw8 *      target_pointer = target->getPixelData();
-  register unsigned char *      mask_pointer = mask->getData();
+  unsigned int          target_size    = target->getNumPixels();
+  const uyvy *          source_pointer = (const uyvy*)(source->getData());
+  raw8 *                target_pointer = target->getPixelData();
+  const unsigned char * mask_pointer = mask->getData();
 
   if (target->getNumPixels() != source->getNumPixels()) {
     fprintf(stderr, "CMVision YUV422_UYVY thresholding: source (num=%d  w=%d  h=%d) and target (num=%d w=%d h=%d) pixel counts do not match!\n", source->getNumPixels(),source->getWidth(),source->getHeight(), target->getNumPixels(),target->getWidth(),target->getHeight());
@@ -53,19 +462,7 @@ bool CMVisionThreshold::thresholdImageYUV422_UYVY(Image<raw8> * target, const Ra
   }
 
   lut->lock();
-  int X_SHIFT=lut->X_SHIFT;
-  int Y_SHIFT=lut->Y_SHIFT;
-  int Z_SHIFT=lut->Z_SHIFT;
-  int Z_AND_Y_BITS=lut->Z_AND_Y_BITS;
-  int Z_BITS = lut->Z_BITS;
-  uyvy p;
-  for (unsigned int i=0;i<target_size;i+=2) {
-    p=source_pointer[(i >> 0x01)];
-    register int B=((p.u >> Y_SHIFT) << Z_BITS);
-    register int C=(p.v >> Z_SHIFT);
-    target_pointer[i] =  mask_pointer[i] & LUT[(((p.y1 >> X_SHIFT) << Z_AND_Y_BITS) | B | C)];
-    target_pointer[i+1] =  mask_pointer[i+1] & LUT[(((p.y2 >> X_SHIFT) << Z_AND_Y_BITS) | B | C)];
-  }
+  threshold_uyvy.get()(source_pointer, target_pointer, mask_pointer, 0, target_size, ThresholdParams(lut));
   lut->unlock();
   return true;
 }
@@ -76,12 +473,10 @@ bool CMVisionThreshold::thresholdImageYUV444(Image<raw8> * target, const ImageIn
     return false;
   }
 
-  register lut_mask_t * LUT = lut->getTable();
-
-  register unsigned int          target_size    = target->getNumPixels();
-  register yuv  *                source_pointer = (yuv*)(source->getData());
-  register raw8 *                target_pointer = target->getPixelData();
-  register unsigned char *       mask_pointer = mask->getData();
+  unsigned int          target_size    = target->getNumPixels();
+  const yuv *           source_pointer = (const yuv*)(source->getData());
+  raw8 *                target_pointer = target->getPixelData();
+  const unsigned char * mask_pointer = mask->getData();
 
   if (target->getNumPixels() != source->getNumPixels()) {
      fprintf(stderr, "CMVision YUV444 thresholding: source (num=%d  w=%d  h=%d) and target (num=%d w=%d h=%d) pixel counts do not match!\n", source->getNumPixels(),source->getWidth(),source->getHeight(), target->getNumPixels(),target->getWidth(),target->getHeight());
@@ -89,16 +484,7 @@ bool CMVisionThreshold::thresholdImageYUV444(Image<raw8> * target, const ImageIn
   }
 
   lut->lock();
-  int X_SHIFT=lut->X_SHIFT;
-  int Y_SHIFT=lut->Y_SHIFT;
-  int Z_SHIFT=lut->Z_SHIFT;
-  int Z_AND_Y_BITS=lut->Z_AND_Y_BITS;
-  int Z_BITS = lut->Z_BITS;
-  yuv p;
-  for (unsigned int i=0;i<target_size;i++) {
-    p=source_pointer[i];
-    target_pointer[i] =  mask_pointer[i] & LUT[(((p.y >> X_SHIFT) << Z_AND_Y_BITS) | ((p.u >> Y_SHIFT) << Z_BITS) | (p.v >> Z_SHIFT))];
-  }
+  threshold_yuv444.get()(source_pointer, target_pointer, mask_pointer, 0, target_size, ThresholdParams(lut));
   lut->unlock();
 
   return true;
@@ -112,81 +498,274 @@ bool CMVisionThreshold::thresholdImageRGB(Image<raw8> * target, const ImageInter
     return false;
   }
 
-  register lut_mask_t * LUT = lut->getTable();
   int source_size    = source->getNumPixels();
   const rgb * source_pointer = (const rgb*)(source->getData());
-  auto * target_pointer = (uint8_t*) target->getPixelData();
-  auto * mask_pointer = mask->getData();
+  raw8 * target_pointer = target->getPixelData();
+  const unsigned char * mask_pointer = mask->getData();
 
   if (target->getNumPixels() != source->getNumPixels()) {
     fprintf(stderr, "CMVision RGB thresholding: source (num=%d  w=%d  h=%d) and target (num=%d w=%d h=%d) pixel counts do not match!\n", source->getNumPixels(),source->getWidth(),source->getHeight(), target->getNumPixels(),target->getWidth(),target->getHeight());
     return false;
   }
 
-  int X_SHIFT=lut->X_SHIFT;
-  int Y_SHIFT=lut->Y_SHIFT;
-  int Z_SHIFT=lut->Z_SHIFT;
-  int Z_AND_Y_BITS=lut->Z_AND_Y_BITS;
-  int Z_BITS = lut->Z_BITS;
+  const ThresholdParams p(lut);
+  rgbKernel(p)(source_pointer, target_pointer, mask_pointer, 0, source_size, p);
 
-#ifdef __AVX2__
-  // unpacking from: https://docs.google.com/presentation/d/1I0-SiHid1hTsv7tjLST2dYW5YF5AJVfs9l4Rg9rvz48/edit#slide=id.g1eefe20b_0_125
-  __m128i ssse3_red_indeces_0 = _mm_set_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 15, 12, 9, 6, 3, 0);
-  __m128i ssse3_red_indeces_1 = _mm_set_epi8(-1, -1, -1, -1, -1, 14, 11, 8, 5, 2, -1, -1, -1, -1, -1, -1);
-  __m128i ssse3_red_indeces_2 = _mm_set_epi8(13, 10, 7, 4, 1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
-  __m128i ssse3_green_indeces_0 = _mm_set_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 13, 10, 7, 4, 1);
-  __m128i ssse3_green_indeces_1 = _mm_set_epi8(-1, -1, -1, -1, -1, 15, 12, 9, 6, 3, 0, -1, -1, -1, -1, -1);
-  __m128i ssse3_green_indeces_2 = _mm_set_epi8(14, 11, 8, 5, 2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
-  __m128i ssse3_blue_indeces_0 = _mm_set_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 14, 11, 8, 5, 2);
-  __m128i ssse3_blue_indeces_1 = _mm_set_epi8(-1, -1, -1, -1, -1, -1, 13, 10, 7, 4, 1, -1, -1, -1, -1, -1);
-  __m128i ssse3_blue_indeces_2 = _mm_set_epi8(15, 12, 9, 6, 3, 0, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+  return true;
+}
 
-  uint16_t idx[16];
-  const rgb* p=&source_pointer[0];
-  const uint8_t* source_pixel = (const uint8_t*)p;
+/// calls \p range(begin, end) for each span of \p row, widened to multiples of
+/// \p pixel_align and clipped to \p width, and clears the pixels of \p row_target
+/// in between. Spans which overlap after widening are handed on as one.
+template <class Range>
+static void forEachSpan(const RowSpans & row, int width, int pixel_align, raw8 * row_target, Range range) {
+  int x=0;
+  int begin=0;
+  int end=0;
+  for (const MaskSpan & span : row) {
+    int b=span.begin / pixel_align * pixel_align;
+    int e=std::min((span.end + pixel_align - 1) / pixel_align * pixel_align, width);
+    if (b >= e) continue;
+    if (b <= end && end > begin) {
+      end=std::max(end, e);
+      continue;
+    }
+    if (begin < end) {
+      range(begin, end);
+      x=end;
+    }
+    memset((void*)(row_target + x), 0, b - x);
+    begin=b;
+    end=e;
+  }
+  if (begin < end) {
+    range(begin, end);
+    x=end;
+  }
+  memset((void*)(row_target + x), 0, width - x);
+}
 
-  for (int i=0; i<source_size; i+=16) {
+/// runs \p kernel on the rows [\p first_row, \p last_row), whose pixels start at
+/// \p source, \p target and \p mask. Without \p spans, the rows are thresholded
+/// as a whole. Otherwise only the spans of each row are, the rest is cleared.
+/// \p pixel_align is the number of pixels sharing one source element.
+template <class Kernel, class Pixel>
+static void thresholdSpans(Kernel kernel, const Pixel * source, raw8 * target, const unsigned char * mask,
+                           int width, int first_row, int last_row, const MaskSpans * spans,
+                           int pixel_align, const ThresholdParams & p) {
+  if (spans == nullptr) {
+    kernel(source, target, mask, 0, (last_row-first_row)*width, p);
+    return;
+  }
+  for (int y=first_row;y<last_row;y++) {
+    unsigned int row=(y-first_row)*width;
+    forEachSpan((*spans)[y], width, pixel_align, target + row, [&](int begin, int end) {
+      kernel(source, target, mask, row + begin, row + end, p);
+    });
+  }
+}
 
-    // crazy RGB unpacking
-    const __m128i chunk0 = _mm_loadu_si128((const __m128i*)(source_pixel));
-    const __m128i chunk1 = _mm_loadu_si128((const __m128i*)(source_pixel + 16));
-    const __m128i chunk2 = _mm_loadu_si128((const __m128i*)(source_pixel + 32));
-    source_pixel += 48;
+/// thresholds the pixels [\p begin, \p end) of row \p y of an RGGB Bayer \p source without
+/// demosaicing it. Each 2x2 quad is looked up once, by the color of Conversions::bayer2rgb,
+/// and its pixels take that class. \p begin has to be even.
+static void thresholdBayerRange(const unsigned char * source, int width, int height, raw8 * row_target,
+                                const unsigned char * row_mask, int y, int begin, int end, const ThresholdParams & p) {
+  const lut_mask_t * LUT=p.LUT;
+  for (int x=begin;x<end;x+=2) {
+    rgb px=Conversions::bayer2rgb(source, width, height, x, y);
+    lut_mask_t c=LUT[(((px.r >> p.X_SHIFT) << p.Z_AND_Y_BITS) | ((px.g >> p.Y_SHIFT) << p.Z_BITS) | (px.b >> p.Z_SHIFT))];
+    row_target[x] = row_mask[x] & c;
+    if (x + 1 < end) row_target[x+1] = row_mask[x+1] & c;
+  }
+}
 
-    const __m128i red = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(chunk0, ssse3_red_indeces_0),
-                                                  _mm_shuffle_epi8(chunk1, ssse3_red_indeces_1)), _mm_shuffle_epi8(chunk2, ssse3_red_indeces_2));
-    const __m128i green = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(chunk0, ssse3_green_indeces_0),
-                                                    _mm_shuffle_epi8(chunk1, ssse3_green_indeces_1)), _mm_shuffle_epi8(chunk2, ssse3_green_indeces_2));
-    const __m128i blue = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(chunk0, ssse3_blue_indeces_0),
-                                                   _mm_shuffle_epi8(chunk1, ssse3_blue_indeces_1)), _mm_shuffle_epi8(chunk2, ssse3_blue_indeces_2));
+/// thresholds the rows [\p first_row, \p last_row) of an RGGB Bayer \p source, see
+/// thresholdBayerRange(). \p target and \p mask start at \p first_row.
+static void thresholdBayerRows(const unsigned char * source, int width, int height, raw8 * target,
+                               const unsigned char * mask, int first_row, int last_row,
+                               const MaskSpans * spans, const ThresholdParams & p) {
+  for (int y=first_row;y<last_row;y++) {
+    raw8 * row_target=target + (y-first_row)*width;
+    const unsigned char * row_mask=mask + (y-first_row)*width;
+    if (spans == nullptr) {
+      thresholdBayerRange(source, width, height, row_target, row_mask, y, 0, width, p);
+      continue;
+    }
+    forEachSpan((*spans)[y], width, 2, row_target, [&](int begin, int end) {
+      thresholdBayerRange(source, width, height, row_target, row_mask, y, begin, end, p);
+    });
+  }
+}
 
-    // widen pixel values to 16bit
-    __m256i r = _mm256_cvtepu8_epi16(red);
-    __m256i b = _mm256_cvtepu8_epi16(blue);
-    __m256i g = _mm256_cvtepu8_epi16(green);
+bool CMVisionThreshold::thresholdRows(raw8 * target, const RawImage * source, YUVLUT * lut, const ImageInterface* mask,
+                                      int first_row, int last_row, const MaskSpans * spans) {
+  int width=source->getWidth();
+  unsigned int first=first_row*width;
+  const unsigned char * mask_pointer = mask->getData() + first;
+  if (mask->getNumPixels() != source->getNumPixels()) {
+    fprintf(stderr, "CMVision row thresholding: image (w=%d h=%d) and mask (w=%d h=%d) sizes do not match!\n", source->getWidth(),source->getHeight(),mask->getWidth(),mask->getHeight());
+    return false;
+  }
+  if (spans != nullptr && (int)spans->size() != source->getHeight()) spans=nullptr;
 
-    // do the original shifts on 16 values in parallel
-    __m256i rs = _mm256_slli_epi16(_mm256_srli_epi16(r, X_SHIFT), Z_AND_Y_BITS);
-    __m256i gs = _mm256_slli_epi16(_mm256_srli_epi16(g, Y_SHIFT), Z_BITS);
-    __m256i bs = _mm256_srli_epi16(b, Z_SHIFT);
+  //the kernels address source, mask and target with the same pixel index
+  if (source->getColorFormat()==COLOR_YUV422_UYVY) {
+    lut->lock();
+    thresholdSpans(threshold_uyvy.get(), (const uyvy*)(source->getData()) + first/2, target, mask_pointer,
+                   width, first_row, last_row, spans, 2, ThresholdParams(lut));
+    lut->unlock();
+  } else if (source->getColorFormat()==COLOR_YUV444) {
+    lut->lock();
+    thresholdSpans(threshold_yuv444.get(), (const yuv*)(source->getData()) + first, target, mask_pointer,
+                   width, first_row, last_row, spans, 1, ThresholdParams(lut));
+    lut->unlock();
+  } else if (source->getColorFormat()==COLOR_RGB8) {
+    RGBLUT * rgblut = (RGBLUT *) lut->getDerivedLUT(CSPACE_RGB);
+    if (rgblut == nullptr) {
+      fprintf(stderr,"CMVision row thresholding: no RGB LUT has been derived from the YUV LUT\n");
+      return false;
+    }
+    const ThresholdParams p(rgblut);
+    thresholdSpans(rgbKernel(p), (const rgb*)(source->getData()) + first, target, mask_pointer,
+                   width, first_row, last_row, spans, 1, p);
+  } else if (source->getColorFormat()==COLOR_RAW8) {
+    RGBLUT * rgblut = (RGBLUT *) lut->getDerivedLUT(CSPACE_RGB);
+    if (rgblut == nullptr) {
+      fprintf(stderr,"CMVision row thresholding: no RGB LUT has been derived from the YUV LUT\n");
+      return false;
+    }
+    thresholdBayerRows(source->getData(), width, source->getHeight(), target, mask_pointer,
+                       first_row, last_row, spans, ThresholdParams(rgblut));
+  } else {
+    fprintf(stderr,"CMVision row thresholding needs YUV422, YUV444, RGB8, or RAW8 (Bayer) as input, but found %s\n", Colors::colorFormatToString(source->getColorFormat()).c_str());
+    return false;
+  }
+  return true;
+}
 
-    // construct LUT indices (ORing)
-    __m256i result = _mm256_or_si256(rs, _mm256_or_si256(gs, bs));
+bool CMVisionThreshold::thresholdRect(raw8 * target, const RawImage * source, YUVLUT * lut, const ImageInterface* mask,
+                                      int x0, int y0, int x1, int y1) {
+  int width=source->getWidth();
+  const unsigned char * mask_pointer = mask->getData();
+  if (mask->getNumPixels() != source->getNumPixels()) {
+    fprintf(stderr, "CMVision rectangle thresholding: image (w=%d h=%d) and mask (w=%d h=%d) sizes do not match!\n", source->getWidth(),source->getHeight(),mask->getWidth(),mask->getHeight());
+    return false;
+  }
 
-    _mm256_storeu_si256((__m256i*)idx, result);
+  //the kernels are given whole image pointers and the pixel indices of each row
+  if (source->getColorFormat()==COLOR_YUV422_UYVY) {
+    lut->lock();
+    ThresholdUYVYKernel kernel=threshold_uyvy.get();
+    const ThresholdParams p(lut);
+    for (int y=y0;y<y1;y++) {
+      kernel((const uyvy*)(source->getData()), target, mask_pointer, y*width + x0, y*width + x1, p);
+    }
+    lut->unlock();
+  } else if (source->getColorFormat()==COLOR_YUV444) {
+    lut->lock();
+    ThresholdYUV444Kernel kernel=threshold_yuv444.get();
+    const ThresholdParams p(lut);
+    for (int y=y0;y<y1;y++) {
+      kernel((const yuv*)(source->getData()), target, mask_pointer, y*width + x0, y*width + x1, p);
+    }
+    lut->unlock();
+  } else if (source->getColorFormat()==COLOR_RGB8 || source->getColorFormat()==COLOR_RAW8) {
+    RGBLUT * rgblut = (RGBLUT *) lut->getDerivedLUT(CSPACE_RGB);
+    if (rgblut == nullptr) {
+      fprintf(stderr,"CMVision rectangle thresholding: no RGB LUT has been derived from the YUV LUT\n");
+      return false;
+    }
+    const ThresholdParams p(rgblut);
+    for (int y=y0;y<y1;y++) {
+      if (source->getColorFormat()==COLOR_RAW8) {
+        thresholdBayerRange(source->getData(), width, source->getHeight(), target + y*width, mask_pointer + y*width, y, x0, x1, p);
+      } else {
+        rgbKernel(p)((const rgb*)(source->getData()), target, mask_pointer, y*width + x0, y*width + x1, p);
+      }
+    }
+  } else {
+    fprintf(stderr,"CMVision rectangle thresholding needs YUV422, YUV444, RGB8, or RAW8 (Bayer) as input, but found %s\n", Colors::colorFormatToString(source->getColorFormat()).c_str());
+    return false;
+  }
+  return true;
+}
 
-#pragma GCC unroll 16
-    for(int j=0; j<16; j++) {
-      target_pointer[i+j] = mask_pointer[i] & LUT[idx[j]];
+/// fills the decimated \p target, with \p lookup(x, y) returning the class of source pixel (x, y)
+template <class Lookup>
+static void thresholdDecimatedRows(Image<raw8> * target, int width, const unsigned char * mask,
+                                   const MaskSpans * spans, Lookup lookup) {
+  int target_width=target->getWidth();
+  for (int y=0;y<target->getHeight();y++) {
+    raw8 * row=target->getPixelData() + y*target_width;
+    const unsigned char * row_mask=mask + 2*y*width;
+    int x=0;
+    if (spans != nullptr) {
+      //the source columns 2x within the spans, the others are cleared
+      for (const MaskSpan & span : (*spans)[2*y]) {
+        int begin=std::max((span.begin + 1) / 2, x);
+        int end=std::min((span.end + 1) / 2, target_width);
+        if (begin >= end) continue;
+        memset((void*)(row + x), 0, begin - x);
+        for (x=begin;x<end;x++) {
+          row[x] = row_mask[2*x] & lookup(2*x, 2*y);
+        }
+      }
+      memset((void*)(row + x), 0, target_width - x);
+      continue;
+    }
+    for (;x<target_width;x++) {
+      row[x] = row_mask[2*x] & lookup(2*x, 2*y);
     }
   }
-#else
-  #pragma GCC unroll 4
-  for (int i=0; i<source_size; i++) {
-    rgb p=source_pointer[i];
-    target_pointer[i] = mask_pointer[i] & LUT[(((p.r >> X_SHIFT) << Z_AND_Y_BITS) | ((p.g >> Y_SHIFT) << Z_BITS) | (p.b >> Z_SHIFT))];
+}
+
+bool CMVisionThreshold::thresholdDecimated(Image<raw8> * target, const RawImage * source, YUVLUT * lut,
+                                           const ImageInterface* mask, const MaskSpans * spans) {
+  int width=source->getWidth();
+  int height=source->getHeight();
+  if (mask->getNumPixels() != source->getNumPixels()) {
+    fprintf(stderr, "CMVision decimated thresholding: image (w=%d h=%d) and mask (w=%d h=%d) sizes do not match!\n", source->getWidth(),source->getHeight(),mask->getWidth(),mask->getHeight());
+    return false;
   }
-#endif
+  if (spans != nullptr && (int)spans->size() != height) spans=nullptr;
+  target->allocate((width + 1) / 2, (height + 1) / 2);
+  const unsigned char * mask_pointer=mask->getData();
 
+  if (source->getColorFormat()==COLOR_YUV422_UYVY) {
+    const uyvy * pixels=(const uyvy*)(source->getData());
+    lut->lock();
+    const ThresholdParams p(lut);
+    //even pixels are the first of their UYVY pair
+    thresholdDecimatedRows(target, width, mask_pointer, spans, [&](int x, int y) {
+      uyvy px=pixels[(y*width + x) >> 1];
+      return p.LUT[(((px.y1 >> p.X_SHIFT) << p.Z_AND_Y_BITS) | ((px.u >> p.Y_SHIFT) << p.Z_BITS) | (px.v >> p.Z_SHIFT))];
+    });
+    lut->unlock();
+  } else if (source->getColorFormat()==COLOR_YUV444) {
+    const yuv * pixels=(const yuv*)(source->getData());
+    lut->lock();
+    const ThresholdParams p(lut);
+    thresholdDecimatedRows(target, width, mask_pointer, spans, [&](int x, int y) {
+      yuv px=pixels[y*width + x];
+      return p.LUT[(((px.y >> p.X_SHIFT) << p.Z_AND_Y_BITS) | ((px.u >> p.Y_SHIFT) << p.Z_BITS) | (px.v >> p.Z_SHIFT))];
+    });
+    lut->unlock();
+  } else if (source->getColorFormat()==COLOR_RGB8 || source->getColorFormat()==COLOR_RAW8) {
+    RGBLUT * rgblut = (RGBLUT *) lut->getDerivedLUT(CSPACE_RGB);
+    if (rgblut == nullptr) {
+      fprintf(stderr,"CMVision decimated thresholding: no RGB LUT has been derived from the YUV LUT\n");
+      return false;
+    }
+    const ThresholdParams p(rgblut);
+    const unsigned char * data=source->getData();
+    bool bayer=(source->getColorFormat()==COLOR_RAW8);
+    thresholdDecimatedRows(target, width, mask_pointer, spans, [&](int x, int y) {
+      rgb px=bayer ? Conversions::bayer2rgb(data, width, height, x, y) : ((const rgb*)data)[y*width + x];
+      return p.LUT[(((px.r >> p.X_SHIFT) << p.Z_AND_Y_BITS) | ((px.g >> p.Y_SHIFT) << p.Z_BITS) | (px.b >> p.Z_SHIFT))];
+    });
+  } else {
+    fprintf(stderr,"CMVision decimated thresholding needs YUV422, YUV444, RGB8, or RAW8 (Bayer) as input, but found %s\n", Colors::colorFormatToString(source->getColorFormat()).c_str());
+    return false;
+  }
   return true;
 }
@@ -27,6 +27,7 @@
 #include "image.h"
 #include "colors.h"
 #include "timer.h"
+#include "mask_spans.h"
 
 /**
 	@author James Bruce (Original CMVision implementation and algorithms),
@@ -41,6 +42,24 @@ public:
   static bool thresholdImageYUV422_UYVY(Image<raw8> * target, const RawImage * source, YUVLUT * lut, const ImageInterface* mask);
   static bool thresholdImageYUV444(Image<raw8> * target, const ImageInterface * source, YUVLUT * lut, const ImageInterface* mask);
   static bool thresholdImageRGB(Image<raw8> * target, const ImageInterface * source, RGBLUT * lut, const ImageInterface* mask);
+
+  /// thresholds the rows [\p first_row, \p last_row) of a YUV422, YUV444 or RGB8 \p source.
+  /// \p target only holds these rows, e.g. a small tile that stays in the cache.
+  /// RGB8 images are thresholded with the RGB LUT derived from \p lut, and so are RAW8
+  /// (RGGB Bayer) images, one lookup per 2x2 quad, without demosaicing them first.
+  /// Given the \p spans of the mask, pixels outside them are cleared without a LUT lookup.
+  static bool thresholdRows(raw8 * target, const RawImage * source, YUVLUT * lut, const ImageInterface* mask,
+                            int first_row, int last_row, const MaskSpans * spans = nullptr);
+  /// thresholds the pixels [\p x0, \p x1) x [\p y0, \p y1) of \p source into the full size
+  /// \p target, leaving its other pixels as they are. \p x0 has to be even for YUV422 and RAW8.
+  static bool thresholdRect(raw8 * target, const RawImage * source, YUVLUT * lut, const ImageInterface* mask,
+                            int x0, int y0, int x1, int y1);
+  /// thresholds every other pixel of every other row of \p source, for a coarse search.
+  /// \p target is allocated to half the width and height (rounded up), its pixel (x, y)
+  /// is the class of source pixel (2x, 2y), or of its Bayer quad for RAW8 images.
+  /// \p spans are given in source coordinates.
+  static bool thresholdDecimated(Image<raw8> * target, const RawImage * source, YUVLUT * lut,
+                                 const ImageInterface* mask, const MaskSpans * spans = nullptr);
 };
 
 #endif
@@ -65,6 +65,10 @@ bool RoboCupSSLClient::open(bool blocking) {
   return(true);
 }
 
+bool RoboCupSSLClient::wait(int timeout_ms) const {
+  return mc.wait(timeout_ms);
+}
+
 bool RoboCupSSLClient::receive(SSL_WrapperPacket & packet) {
   Net::Address src;
   int r=0;
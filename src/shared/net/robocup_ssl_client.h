@@ -47,6 +47,8 @@ public:
     bool open(bool blocking=false);
     void close();
     bool receive(SSL_WrapperPacket & packet);
+    /// blocks until a packet can be received, or \p timeout_ms expired (-1 waits forever)
+    bool wait(int timeout_ms = -1) const;
 
 };
 
@@ -64,13 +64,14 @@ bool RoboCupSSLServer::open() {
   return(true);
 }
 
-bool RoboCupSSLServer::send(const SSL_DetectionFrame & frame) {
+bool RoboCupSSLServer::send(SSL_DetectionFrame & frame) {
   SSL_WrapperPacket pkt;
-  SSL_DetectionFrame * nframe = pkt.mutable_detection();
-  nframe->CopyFrom(frame);
   mutex.lock();
-  nframe->set_t_sent(GetTimeSec());
+  frame.set_t_sent(GetTimeSec());
+  //the frame is only lent to the packet, it is released before the packet is destroyed
+  pkt.unsafe_arena_set_allocated_detection(&frame);
   bool ret = sendWrapperPacket<SSL_WrapperPacket>(pkt);
+  pkt.unsafe_arena_release_detection();
   mutex.unlock();
   return ret;
 }
@@ -85,13 +86,13 @@ bool RoboCupSSLServer::send(const SSL_GeometryData & geometry) {
   return ret;
 }
 
-bool RoboCupSSLServer::sendLegacyMessage(const SSL_DetectionFrame& frame) {
+bool RoboCupSSLServer::sendLegacyMessage(SSL_DetectionFrame& frame) {
   RoboCup2014Legacy::Wrapper::SSL_WrapperPacket pkt;
-  SSL_DetectionFrame * nframe = pkt.mutable_detection();
-  nframe->CopyFrom(frame);
   mutex.lock();
-  nframe->set_t_sent(GetTimeSec());
+  frame.set_t_sent(GetTimeSec());
+  pkt.unsafe_arena_set_allocated_detection(&frame);
   bool ret = sendWrapperPacket<RoboCup2014Legacy::Wrapper::SSL_WrapperPacket>(pkt);
+  pkt.unsafe_arena_release_detection();
   mutex.unlock();
   return ret;
 }
@@ -40,6 +40,7 @@ protected:
   int _port;
   string _net_address;
   string _net_interface;
+  string send_buffer; //reused for every packet, guarded by mutex
 
 public:
     RoboCupSSLServer(int port,
@@ -49,9 +50,10 @@ public:
     ~RoboCupSSLServer();
     bool open();
     void close();
+    /// sends \p packet. The caller must hold the mutex.
     template <typename T>
     bool sendWrapperPacket(const T & packet) {
-      string buffer;
+      string & buffer=send_buffer;
       packet.SerializeToString(&buffer);
       Net::Address multiaddr;
       multiaddr.setHost(_net_address.c_str(),_port);
@@ -69,11 +71,13 @@ public:
       return(result);
     }
 
-    bool send(const SSL_DetectionFrame & frame);
+    /// sends \p frame in a wrapper packet, setting its t_sent.
+    /// the packet references the frame instead of copying it.
+    bool send(SSL_DetectionFrame & frame);
     bool send(const SSL_GeometryData & geometry);
     bool sendLegacyMessage(
         const RoboCup2014Legacy::Geometry::SSL_GeometryData & geometry);
-    bool sendLegacyMessage(const SSL_DetectionFrame & frame);
+    bool sendLegacyMessage(SSL_DetectionFrame & frame);
 
 };
 
@@ -19,13 +19,64 @@
 */
 //========================================================================
 #include "affinity_manager.h"
+#include <map>
+#include <utility>
+
+thread_local AffinityManager::Placement AffinityManager::current_placement;
+bool AffinityManager::verbose=false;
+
+/// reads a single integer from a sysfs file
+static bool readSysInt(const char * path, int & value) {
+  FILE * f=fopen(path,"r");
+  if (f==0) return false;
+  bool res=(fscanf(f,"%d",&value)==1);
+  fclose(f);
+  return res;
+}
+
+/// reads a sysfs cpu list such as "0-3,8-11"
+static bool readSysList(const char * path, vector<int> & ids) {
+  ids.clear();
+  FILE * f=fopen(path,"r");
+  if (f==0) return false;
+  char buf[4096];
+  bool res=(fgets(buf,sizeof(buf),f)!=0);
+  fclose(f);
+  if (!res) return false;
+  char * p=buf;
+  while (*p!=0) {
+    char * end;
+    long first=strtol(p,&end,10);
+    if (end==p) break;
+    long last=first;
+    p=end;
+    if (*p=='-') {
+      p++;
+      last=strtol(p,&end,10);
+      p=end;
+    }
+    for (long i=first;i<=last;i++) ids.push_back((int)i);
+    if (*p==',') p++;
+  }
+  return !ids.empty();
+}
 
 AffinityManager::AffinityManager()
 {
   _mutex=new pthread_mutex_t;
   pthread_mutex_init((pthread_mutex_t*)_mutex, NULL);
   max_cpu_id=0;
-  parseCpuInfo();
+  num_cameras=1;
+  realtime_capture=false;
+  if (!parseSysTopology()) {
+    parseCpuInfo();
+    //without topology information, all cores form a single domain
+    domains.clear();
+    domains.resize(1);
+    for (unsigned int i=0;i<cores.size();i++) {
+      if (cores[i].enabled) domains[0].cores.push_back(i);
+    }
+  }
 }
 
 AffinityManager::~AffinityManager()
@@ -74,6 +125,230 @@ void AffinityManager::demandCore(int core) {
   DT_UNLOCK;
 }
 
+void AffinityManager::setCameraCount(int n) {
+  DT_LOCK;
+  num_cameras = n < 1 ? 1 : n;
+  DT_UNLOCK;
+}
+
+void AffinityManager::setRealtimeCapture(bool enabled) {
+  DT_LOCK;
+  realtime_capture=enabled;
+  DT_UNLOCK;
+}
+
+void AffinityManager::setVerbose(bool enabled) {
+  verbose=enabled;
+}
+
+int AffinityManager::captureCoreOf(int camera) const {
+  if (domains.empty()) return -1;
+  if (camera < 0) camera=0;
+  int n_domains=domains.size();
+  const CacheDomain & d=domains[camera % n_domains];
+  int rank=camera / n_domains;
+  return d.cores[rank % d.cores.size()];
+}
+
+bool AffinityManager::isCaptureCore(int core) const {
+  for (int i=0;i<num_cameras;i++) {
+    if (captureCoreOf(i)==core) return true;
+  }
+  return false;
+}
+
+void AffinityManager::setThreadAffinity(const vector<int> & core_indices, const char * role, int camera) {
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  for (unsigned int i=0;i<core_indices.size();i++) {
+    const PhysicalCore & c=cores[core_indices[i]];
+    for (unsigned int j=0;j<c.processor_ids.size();j++) {
+      CPU_SET(c.processor_ids[j],&cpu_set);
+    }
+  }
+  unsigned int tid=(long int)syscall(__NR_gettid);
+  if (sched_setaffinity(tid, sizeof(cpu_set), &cpu_set) != 0) {
+    fprintf(stderr,"Error while setting affinity of thread %d (%s)\n",tid,role);
+  } else if (verbose) {
+    printf("Affinity: thread %d (%s",tid,role);
+    if (camera >= 0) printf(" of camera %d",camera);
+    printf(") on CPUs:");
+    for (int i=0;i<CPU_SETSIZE;i++) {
+      if (CPU_ISSET(i,&cpu_set)) printf(" %d",i);
+    }
+    printf("\n");
+  }
+}
+
+void AffinityManager::setThreadScheduling(bool realtime) {
+  int policy;
+  struct sched_param param;
+  if (pthread_getschedparam(pthread_self(), &policy, &param) != 0) return;
+  if (realtime) {
+    //leave some headroom above us for kernel threads and the driver
+    param.sched_priority=sched_get_priority_max(SCHED_FIFO) / 2;
+    if (pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) != 0) {
+      fprintf(stderr,"Unable to set real-time priority for the capture thread (requires CAP_SYS_NICE)\n");
+    }
+  } else if (policy != SCHED_OTHER) {
+    //threads inherit the policy of their creator, but only capture threads should run real-time
+    param.sched_priority=0;
+    pthread_setschedparam(pthread_self(), SCHED_OTHER, &param);
+  }
+}
+
+void AffinityManager::demandCaptureCore(int camera) {
+  DT_LOCK;
+  int core=captureCoreOf(camera);
+  if (core >= 0) {
+    setThreadAffinity(vector<int>(1,core), "capture", camera);
+  }
+  setThreadScheduling(realtime_capture);
+  current_placement.manager=this;
+  current_placement.camera=camera;
+  DT_UNLOCK;
+}
+
+void AffinityManager::demandWorkerCores(int camera) {
+  DT_LOCK;
+  if (!domains.empty()) {
+    const CacheDomain & d=domains[(camera < 0 ? 0 : camera) % domains.size()];
+    vector<int> worker_cores;
+    for (unsigned int i=0;i<d.cores.size();i++) {
+      if (!isCaptureCore(d.cores[i])) worker_cores.push_back(d.cores[i]);
+    }
+    //more cameras than cores in this domain: share the whole domain
+    setThreadAffinity(worker_cores.empty() ? d.cores : worker_cores, "worker", camera);
+  }
+  setThreadScheduling(false);
+  current_placement.manager=this;
+  current_placement.camera=camera;
+  DT_UNLOCK;
+}
+
+void AffinityManager::demandAuxiliaryCores() {
+  DT_LOCK;
+  vector<int> all_cores;
+  vector<int> aux_cores;
+  for (unsigned int i=0;i<domains.size();i++) {
+    for (unsigned int j=0;j<domains[i].cores.size();j++) {
+      int c=domains[i].cores[j];
+      all_cores.push_back(c);
+      if (!isCaptureCore(c)) aux_cores.push_back(c);
+    }
+  }
+  if (!all_cores.empty()) {
+    setThreadAffinity(aux_cores.empty() ? all_cores : aux_cores, "auxiliary", -1);
+  }
+  setThreadScheduling(false);
+  current_placement.manager=this;
+  current_placement.camera=-1;
+  DT_UNLOCK;
+}
+
+AffinityManager::Placement AffinityManager::getPlacement() {
+  return current_placement;
+}
+
+void AffinityManager::Placement::demandWorkerCores() const {
+  if (manager==0) return;
+  if (camera < 0) {
+    manager->demandAuxiliaryCores();
+  } else {
+    manager->demandWorkerCores(camera);
+  }
+}
+
+void AffinityManager::Placement::demandAuxiliaryCores() const {
+  if (manager==0) return;
+  manager->demandAuxiliaryCores();
+}
+
+bool AffinityManager::parseSysTopology() {
+  vector<int> cpus;
+  if (!readSysList("/sys/devices/system/cpu/online",cpus)) return false;
+
+  //map each cpu to its NUMA node
+  std::map<int,int> cpu_node;
+  vector<int> nodes;
+  if (readSysList("/sys/devices/system/node/online",nodes)) {
+    for (unsigned int i=0;i<nodes.size();i++) {
+      char path[256];
+      vector<int> node_cpus;
+      snprintf(path,sizeof(path),"/sys/devices/system/node/node%d/cpulist",nodes[i]);
+      if (!readSysList(path,node_cpus)) continue;
+      for (unsigned int j=0;j<node_cpus.size();j++) cpu_node[node_cpus[j]]=nodes[i];
+    }
+  }
+
+  std::map<int,int> core_of_sibling;            //first SMT sibling -> index into cores
+  std::map<std::pair<int,int>,int> domain_of_key; //(NUMA node, first cpu sharing the L3) -> index into domains
+  cores.clear();
+  domains.clear();
+  max_cpu_id=0;
+  for (unsigned int i=0;i<cpus.size();i++) {
+    int cpu=cpus[i];
+    char path[256];
+    vector<int> ids;
+    if (cpu > max_cpu_id) max_cpu_id=cpu;
+
+    snprintf(path,sizeof(path),"/sys/devices/system/cpu/cpu%d/topology/thread_siblings_list",cpu);
+    int sibling_key = readSysList(path,ids) ? ids[0] : cpu;
+
+    //the last level cache shared by this cpu. fall back to the package if there is no L3
+    int cache_key=-1;
+    for (int index=0;index<16;index++) {
+      int level;
+      snprintf(path,sizeof(path),"/sys/devices/system/cpu/cpu%d/cache/index%d/level",cpu,index);
+      if (!readSysInt(path,level)) break;
+      if (level!=3) continue;
+      snprintf(path,sizeof(path),"/sys/devices/system/cpu/cpu%d/cache/index%d/shared_cpu_list",cpu,index);
+      if (readSysList(path,ids)) cache_key=ids[0];
+    }
+    if (cache_key < 0) {
+      int package=0;
+      snprintf(path,sizeof(path),"/sys/devices/system/cpu/cpu%d/topology/physical_package_id",cpu);
+      readSysInt(path,package);
+      cache_key=-1-package;
+    }
+    int node = cpu_node.count(cpu) ? cpu_node[cpu] : 0;
+
+    std::pair<int,int> domain_key(node,cache_key);
+    if (domain_of_key.count(domain_key)==0) {
+      domain_of_key[domain_key]=domains.size();
+      domains.push_back(CacheDomain());
+      domains.back().numa_node=node;
+    }
+    int domain=domain_of_key[domain_key];
+
+    if (core_of_sibling.count(sibling_key)==0) {
+      core_of_sibling[sibling_key]=cores.size();
+      cores.push_back(PhysicalCore());
+      cores.back().enabled=true;
+      cores.back().domain=domain;
+      domains[domain].cores.push_back(cores.size()-1);
+    }
+    cores[core_of_sibling[sibling_key]].processor_ids.push_back(cpu);
+  }
+  if (cores.empty()) return false;
+
+  printf("== Affinity Manager CPU Topology ==================================\n");
+  printf(" Found %zu core(s) in %zu cache domain(s):\n", cores.size(), domains.size());
+  for (unsigned int d=0;d<domains.size();d++) {
+    printf(" - Domain %d (NUMA node %d):\n",d,domains[d].numa_node);
+    for (unsigned int i=0;i<domains[d].cores.size();i++) {
+      const PhysicalCore & c=cores[domains[d].cores[i]];
+      printf("   - Core %d with %zu HT Processor(s) (IDs: ",domains[d].cores[i],c.processor_ids.size());
+      for (unsigned j=0;j<c.processor_ids.size();j++) {
+        printf("[%d] ",c.processor_ids[j]);
+      }
+      printf(")\n");
+    }
+  }
+  printf("==================================================================\n");
+  return true;
+}
+
 int AffinityManager::parseFileUpTo(FILE * f, char * output, int len, char end) {
   char c=0;
   char prev_c=0;
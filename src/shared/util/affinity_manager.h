@@ -36,6 +36,20 @@ using namespace std;
 
 /**
 	@author Stefan Zickler
+
+  The CPU topology is read from /sys/devices/system/cpu. Physical cores
+  (all SMT siblings) are grouped into cache domains, i.e. cores sharing
+  the same L3 cache and NUMA node. If sysfs is not available, /proc/cpuinfo
+  is parsed instead and all cores form a single domain.
+
+  Placement policy for n cameras:
+   - camera k is assigned to domain k % #domains and gets one physical core
+     of that domain for its capture thread.
+   - the worker threads of camera k (processing stage, threshold workers)
+     use the remaining cores of the same domain.
+   - all other threads (GUI, DVR writer, calibration, network) use every
+     core which is not a capture core.
+  Optionally, capture threads are run with real-time (SCHED_FIFO) priority.
 */
 class AffinityManager{
 public:
@@ -43,20 +57,79 @@ public:
     public:
     bool enabled;
     vector<int> processor_ids;
+    int domain;
     PhysicalCore() {
       enabled=false;
       processor_ids.clear();
+      domain=0;
+    }
+  };
+  class CacheDomain {
+    public:
+    vector<int> cores; //indices into AffinityManager::cores
+    int numa_node;
+    CacheDomain() {
+      numa_node=0;
+    }
+  };
+
+  /*!
+    \brief The placement of a thread, so that threads it spawns can be placed alike
+
+    Threads which do not know their camera (e.g. plugin workers) take a copy
+    of getPlacement() in the spawning thread and apply it in the new thread.
+  */
+  class Placement {
+    public:
+    AffinityManager * manager;
+    int camera; //-1 for auxiliary threads
+    Placement() {
+      manager=0;
+      camera=-1;
     }
+    /// places the calling thread on the worker cores of the camera (auxiliary cores if camera is -1)
+    void demandWorkerCores() const;
+    /// places the calling thread on the auxiliary cores
+    void demandAuxiliaryCores() const;
   };
 protected:
     pthread_mutex_t * _mutex;
     vector<PhysicalCore> cores;
+    vector<CacheDomain> domains;
     int max_cpu_id;
+    int num_cameras;
+    bool realtime_capture;
+    static bool verbose;
+    static thread_local Placement current_placement;
     int parseFileUpTo(FILE * f, char * output, int len, char end);
     void parseCpuInfo();
+    bool parseSysTopology();
+    int captureCoreOf(int camera) const;
+    bool isCaptureCore(int core) const;
+    void setThreadAffinity(const vector<int> & core_indices, const char * role, int camera);
+    void setThreadScheduling(bool realtime);
 public:
 
+    /// pins the calling thread to the physical core \p core (modulo the number of cores)
     void demandCore(int core);
+
+    /// sets the number of cameras the cores are distributed among
+    void setCameraCount(int n);
+    /// if enabled, capture threads are run with SCHED_FIFO priority
+    void setRealtimeCapture(bool enabled);
+    /// if enabled, the placement of every thread is printed
+    static void setVerbose(bool enabled);
+
+    /// places the calling thread as the capture thread of \p camera
+    void demandCaptureCore(int camera);
+    /// places the calling thread as a worker thread of \p camera
+    void demandWorkerCores(int camera);
+    /// places the calling thread on the cores not used for capturing
+    void demandAuxiliaryCores();
+
+    /// returns the placement of the calling thread (manager is 0 if it was never placed)
+    static Placement getPlacement();
+
     AffinityManager();
 
     ~AffinityManager();
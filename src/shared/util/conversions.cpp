@@ -24,6 +24,10 @@
 
 
 #include "conversions.h"
+#include "simd_dispatch.h"
+#ifdef SIMD_DISPATCH_X86
+#include <x86intrin.h>
+#endif
 
 using namespace std;
 // The following #define is there for the users who experience green/purple
@@ -95,39 +99,134 @@ void Conversions::uyv2rgb ( unsigned char *src,
   }
 }
 
+// uyvy2rgb kernels: convert the macropixels [first, last). The SIMD variants
+// use the same integer arithmetic as yuv2rgb(), so all of them produce
+// identical images.
+typedef void (*UYVY2RGBKernel)(const unsigned char * src, unsigned char * dest, int first, int last);
+
+static void uyvy2rgb_Scalar(const unsigned char * src, unsigned char * dest, int first, int last) {
+  int y0, y1, u, v;
+  int r, g, b;
+  src+=4*first;
+  dest+=6*first;
+  for (int k=first;k<last;k++) {
+    u  = ( unsigned char ) src[0] - 128;
+    y0 = ( unsigned char ) src[1];
+    v  = ( unsigned char ) src[2] - 128;
+    y1 = ( unsigned char ) src[3];
+    src+=4;
+    Conversions::yuv2rgb ( y0, u, v, r, g, b );
+    dest[0] = r;
+    dest[1] = g;
+    dest[2] = b;
+    Conversions::yuv2rgb ( y1, u, v, r, g, b );
+    dest[3] = r;
+    dest[4] = g;
+    dest[5] = b;
+    dest+=6;
+  }
+}
+
+#ifdef SIMD_DISPATCH_X86
+// The vector variants hold one macropixel per 32 bit lane and produce the
+// r, g and b values of 8 pixels per 128 bit lane, which are interleaved
+// into 24 output bytes by byte shuffles.
+
+SIMD_TARGET("sse4.1")
+static void uyvy2rgb_SSE41(const unsigned char * src, unsigned char * dest, int first, int last) {
+  const __m128i byte_mask = _mm_set1_epi32(0xFF);
+  const __m128i offset = _mm_set1_epi32(128);
+  //r and g of 8 pixels are in the first and second half of rg, b in the first half of bb
+  const __m128i rg_to_out0 = _mm_setr_epi8(0, 8, -1, 1, 9, -1, 2, 10, -1, 3, 11, -1, 4, 12, -1, 5);
+  const __m128i bb_to_out0 = _mm_setr_epi8(-1, -1, 0, -1, -1, 1, -1, -1, 2, -1, -1, 3, -1, -1, 4, -1);
+  const __m128i rg_to_out1 = _mm_setr_epi8(13, -1, 6, 14, -1, 7, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+  const __m128i bb_to_out1 = _mm_setr_epi8(-1, 5, -1, -1, 6, -1, -1, 7, -1, -1, -1, -1, -1, -1, -1, -1);
+  int k=first;
+  for (; k + 4 <= last; k+=4) {
+    const __m128i mp = _mm_loadu_si128((const __m128i*)(src + 4*k));
+    const __m128i u  = _mm_sub_epi32(_mm_and_si128(mp, byte_mask), offset);
+    const __m128i y0 = _mm_and_si128(_mm_srli_epi32(mp, 8), byte_mask);
+    const __m128i v  = _mm_sub_epi32(_mm_and_si128(_mm_srli_epi32(mp, 16), byte_mask), offset);
+    const __m128i y1 = _mm_srli_epi32(mp, 24);
+    const __m128i dr = _mm_srai_epi32(_mm_mullo_epi32(v, _mm_set1_epi32(1436)), 10);
+    const __m128i dg = _mm_srai_epi32(_mm_add_epi32(_mm_mullo_epi32(u, _mm_set1_epi32(352)), _mm_mullo_epi32(v, _mm_set1_epi32(731))), 10);
+    const __m128i db = _mm_srai_epi32(_mm_mullo_epi32(u, _mm_set1_epi32(1814)), 10);
+    //interleave both pixels of each macropixel, saturating packs do the bounding
+    const __m128i y_lo = _mm_unpacklo_epi32(y0, y1);
+    const __m128i y_hi = _mm_unpackhi_epi32(y0, y1);
+    const __m128i dr_lo = _mm_unpacklo_epi32(dr, dr);
+    const __m128i dr_hi = _mm_unpackhi_epi32(dr, dr);
+    const __m128i dg_lo = _mm_unpacklo_epi32(dg, dg);
+    const __m128i dg_hi = _mm_unpackhi_epi32(dg, dg);
+    const __m128i db_lo = _mm_unpacklo_epi32(db, db);
+    const __m128i db_hi = _mm_unpackhi_epi32(db, db);
+    const __m128i r = _mm_packs_epi32(_mm_add_epi32(y_lo, dr_lo), _mm_add_epi32(y_hi, dr_hi));
+    const __m128i g = _mm_packs_epi32(_mm_sub_epi32(y_lo, dg_lo), _mm_sub_epi32(y_hi, dg_hi));
+    const __m128i b = _mm_packs_epi32(_mm_add_epi32(y_lo, db_lo), _mm_add_epi32(y_hi, db_hi));
+    const __m128i rg = _mm_packus_epi16(r, g);
+    const __m128i bb = _mm_packus_epi16(b, b);
+    unsigned char * d = dest + 6*k;
+    _mm_storeu_si128((__m128i*)d, _mm_or_si128(_mm_shuffle_epi8(rg, rg_to_out0), _mm_shuffle_epi8(bb, bb_to_out0)));
+    _mm_storel_epi64((__m128i*)(d + 16), _mm_or_si128(_mm_shuffle_epi8(rg, rg_to_out1), _mm_shuffle_epi8(bb, bb_to_out1)));
+  }
+  uyvy2rgb_Scalar(src, dest, k, last);
+}
+
+SIMD_TARGET("avx2")
+static void uyvy2rgb_AVX2(const unsigned char * src, unsigned char * dest, int first, int last) {
+  const __m256i byte_mask = _mm256_set1_epi32(0xFF);
+  const __m256i offset = _mm256_set1_epi32(128);
+  //same shuffles as the SSE4.1 variant, applied to each 128 bit lane
+  const __m256i rg_to_out0 = _mm256_broadcastsi128_si256(_mm_setr_epi8(0, 8, -1, 1, 9, -1, 2, 10, -1, 3, 11, -1, 4, 12, -1, 5));
+  const __m256i bb_to_out0 = _mm256_broadcastsi128_si256(_mm_setr_epi8(-1, -1, 0, -1, -1, 1, -1, -1, 2, -1, -1, 3, -1, -1, 4, -1));
+  const __m256i rg_to_out1 = _mm256_broadcastsi128_si256(_mm_setr_epi8(13, -1, 6, 14, -1, 7, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1));
+  const __m256i bb_to_out1 = _mm256_broadcastsi128_si256(_mm_setr_epi8(-1, 5, -1, -1, 6, -1, -1, 7, -1, -1, -1, -1, -1, -1, -1, -1));
+  int k=first;
+  for (; k + 8 <= last; k+=8) {
+    const __m256i mp = _mm256_loadu_si256((const __m256i*)(src + 4*k));
+    const __m256i u  = _mm256_sub_epi32(_mm256_and_si256(mp, byte_mask), offset);
+    const __m256i y0 = _mm256_and_si256(_mm256_srli_epi32(mp, 8), byte_mask);
+    const __m256i v  = _mm256_sub_epi32(_mm256_and_si256(_mm256_srli_epi32(mp, 16), byte_mask), offset);
+    const __m256i y1 = _mm256_srli_epi32(mp, 24);
+    const __m256i dr = _mm256_srai_epi32(_mm256_mullo_epi32(v, _mm256_set1_epi32(1436)), 10);
+    const __m256i dg = _mm256_srai_epi32(_mm256_add_epi32(_mm256_mullo_epi32(u, _mm256_set1_epi32(352)), _mm256_mullo_epi32(v, _mm256_set1_epi32(731))), 10);
+    const __m256i db = _mm256_srai_epi32(_mm256_mullo_epi32(u, _mm256_set1_epi32(1814)), 10);
+    //unpacking and packing stay within 128 bit lanes: each lane holds 8 consecutive pixels
+    const __m256i y_lo = _mm256_unpacklo_epi32(y0, y1);
+    const __m256i y_hi = _mm256_unpackhi_epi32(y0, y1);
+    const __m256i dr_lo = _mm256_unpacklo_epi32(dr, dr);
+    const __m256i dr_hi = _mm256_unpackhi_epi32(dr, dr);
+    const __m256i dg_lo = _mm256_unpacklo_epi32(dg, dg);
+    const __m256i dg_hi = _mm256_unpackhi_epi32(dg, dg);
+    const __m256i db_lo = _mm256_unpacklo_epi32(db, db);
+    const __m256i db_hi = _mm256_unpackhi_epi32(db, db);
+    const __m256i r = _mm256_packs_epi32(_mm256_add_epi32(y_lo, dr_lo), _mm256_add_epi32(y_hi, dr_hi));
+    const __m256i g = _mm256_packs_epi32(_mm256_sub_epi32(y_lo, dg_lo), _mm256_sub_epi32(y_hi, dg_hi));
+    const __m256i b = _mm256_packs_epi32(_mm256_add_epi32(y_lo, db_lo), _mm256_add_epi32(y_hi, db_hi));
+    const __m256i rg = _mm256_packus_epi16(r, g);
+    const __m256i bb = _mm256_packus_epi16(b, b);
+    const __m256i out0 = _mm256_or_si256(_mm256_shuffle_epi8(rg, rg_to_out0), _mm256_shuffle_epi8(bb, bb_to_out0));
+    const __m256i out1 = _mm256_or_si256(_mm256_shuffle_epi8(rg, rg_to_out1), _mm256_shuffle_epi8(bb, bb_to_out1));
+    unsigned char * d = dest + 6*k;
+    _mm_storeu_si128((__m128i*)d, _mm256_castsi256_si128(out0));
+    _mm_storel_epi64((__m128i*)(d + 16), _mm256_castsi256_si128(out1));
+    _mm_storeu_si128((__m128i*)(d + 24), _mm256_extracti128_si256(out0, 1));
+    _mm_storel_epi64((__m128i*)(d + 40), _mm256_extracti128_si256(out1, 1));
+  }
+  uyvy2rgb_Scalar(src, dest, k, last);
+}
+
+static const SimdKernel<UYVY2RGBKernel> uyvy2rgb_kernel(uyvy2rgb_Scalar, uyvy2rgb_SSE41, uyvy2rgb_AVX2, nullptr);
+#else
+static const SimdKernel<UYVY2RGBKernel> uyvy2rgb_kernel(uyvy2rgb_Scalar, nullptr, nullptr, nullptr);
+#endif
+
 void Conversions::uyvy2rgb ( unsigned char *src,
                              unsigned char *dest,
                              int width,
                              int height ) {
-  #ifndef NO_DC1394_CONVERSIONS
-    dc1394_convert_to_RGB8(src,dest, width, height, DC1394_BYTE_ORDER_UYVY,
-                       DC1394_COLOR_CODING_YUV422, 8);
-  #else
-  
-  int NumPixels = width*height;
-                             
-  register int max_i = ( NumPixels << 1 )-1;
-  //register int max_j = NumPixels + ( NumPixels << 1 ) -1;
-  register int i = 0;
-  register int j = 0;
-  register int y0, y1, u, v;
-  register int r, g, b;
-
-  while ( i < max_i ) {
-    u  = ( unsigned char ) src[i++] - 128;
-    y0 = ( unsigned char ) src[i++];
-    v  = ( unsigned char ) src[i++] - 128;
-    y1 = ( unsigned char ) src[i++];
-    yuv2rgb ( y0, u, v, r, g, b );
-    dest[j++] = r;
-    dest[j++] = g;
-    dest[j++] = b;
-    yuv2rgb ( y1, u, v, r, g, b );
-    dest[j++] = r;
-    dest[j++] = g;
-    dest[j++] = b;
-  }
-  #endif
+  //not converted by libdc1394 anymore, the dispatched kernels are considerably faster
+  uyvy2rgb_kernel.get()(src, dest, 0, (width*height) >> 1);
 }
 
 void Conversions::yuyv2rgb ( unsigned char *src,
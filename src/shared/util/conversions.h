@@ -106,6 +106,23 @@ inline static yuv uyvy2yuv(const uyvy &color_uyvy, int x) {
   return color_yuv;
 }
 
+/// the color of the 2x2 quad of an RGGB Bayer image that pixel (\p x, \p y) is part of:
+/// its red, the mean of its two greens, and its blue value. A quad cut off by an odd
+/// image size reuses the last row or column.
+inline static rgb bayer2rgb(const unsigned char * src, int width, int height, int x, int y) {
+  int x0 = x & ~1;
+  int y0 = y & ~1;
+  int x1 = (x0 + 1 < width) ? x0 + 1 : x0;
+  int y1 = (y0 + 1 < height) ? y0 + 1 : y0;
+  const unsigned char * even = src + y0 * width;
+  const unsigned char * odd = src + y1 * width;
+  rgb col;
+  col.r = even[x0];
+  col.g = (unsigned char) ((even[x1] + odd[x0]) >> 1);
+  col.b = odd[x1];
+  return col;
+}
+
 //DC1394 accelerated:
 static void uyvy2rgb (unsigned char *src, unsigned char *dest, int width, int height);
 static void yuyv2rgb ( unsigned char *src, unsigned char *dest, int width, int height);
@@ -3,11 +3,16 @@
 #include <tuple>
 #include <iostream>
 
-void computeMask(const ConvexHull &convex_hull, Image<raw8> &mask) {
+void computeMask(const ConvexHull &convex_hull, Image<raw8> &mask, MaskSpans &spans) {
   const auto WHITE = raw8(255);
 
+  spans.resize(mask.getHeight());
   if(convex_hull._points.empty()) {
     mask.fillColor(WHITE);
+    for (RowSpans &row : spans) {
+      row.clear();
+      addSpan(row, 0, mask.getWidth());
+    }
     return;
   }
 
@@ -19,12 +24,13 @@ void computeMask(const ConvexHull &convex_hull, Image<raw8> &mask) {
     mask.drawLine(a.x, a.y, b.x, b.y, WHITE);
   }
 
-  if (convex_hull.getNumPoints() < 3)
-    return;
+  const bool fill = convex_hull.getNumPoints() >= 3;
 
   // linescan, top - bot, left - right
-  // first find where the whites should be painted, and then paint them
+  // first find where the whites should be painted, and then paint them.
+  // the span of each row covers its whites, whether they were painted or not
   for (int y = 0; y < mask.getHeight(); ++y) {
+    spans[y].clear();
     int minX = mask.getWidth();  // never min
     int maxX = 0;
     for (int x = 0; x < mask.getWidth(); ++x) {
@@ -33,7 +39,10 @@ void computeMask(const ConvexHull &convex_hull, Image<raw8> &mask) {
         maxX = x;
       }
     }
-    if (minX == mask.getWidth() ||  // no whites
+    if (minX == mask.getWidth())  // no whites
+      continue;
+    addSpan(spans[y], minX, maxX + 1);
+    if (!fill ||
 	minX == maxX)                // single white
       continue;
 
@@ -60,7 +69,7 @@ void ConvexHullImageMask::slotMaskPointsRead() {
 }
 
 ConvexHullImageMask::ConvexHullImageMask(const std::string &filename)
-  : _convex_hull(), _mask() {
+  : _convex_hull(), _mask(), _revision(0) {
   if (filename == "") {
     _v_settings = 0;
     _v_list = 0;
@@ -82,7 +91,8 @@ void ConvexHullImageMask::reset() {
   lock();
 
   _convex_hull.clear();
-  computeMask(_convex_hull, _mask);
+  computeMask(_convex_hull, _mask, _spans);
+  _revision++;
   _v_list->resetToDefault();
 
   unlock();
@@ -92,7 +102,8 @@ void ConvexHullImageMask::_addPoint(const int x, const int y, const bool add_to_
   const bool changed = _convex_hull.addPoint(x, y);
 
   if (changed) {
-    computeMask(_convex_hull, _mask);
+    computeMask(_convex_hull, _mask, _spans);
+    _revision++;
 
     if (add_to_list) {
       VarTypes::VarList *point = new VarTypes::VarList();
@@ -119,7 +130,8 @@ void ConvexHullImageMask::removePoint(const int x, const int y, const int margin
       changed = _convex_hull.removePoint(x + w, y + h);
 
   if (changed) {
-    computeMask(_convex_hull, _mask);
+    computeMask(_convex_hull, _mask, _spans);
+    _revision++;
 
     _v_list->resetToDefault();
     for (auto it = _convex_hull.begin(); it != _convex_hull.end(); ++it) {
@@ -139,7 +151,8 @@ void ConvexHullImageMask::removePoint(const int x, const int y, const int margin
 void ConvexHullImageMask::setSize(const int w, const int h) {
   lock();
   _mask.allocate(w, h);
-  computeMask(_convex_hull, _mask);
+  computeMask(_convex_hull, _mask, _spans);
+  _revision++;
   unlock();
 }
 
@@ -179,6 +192,14 @@ const Image<raw8>& ConvexHullImageMask::getMask() const {
   return _mask;
 }
 
+const MaskSpans& ConvexHullImageMask::getSpans() const {
+  return _spans;
+}
+
+int ConvexHullImageMask::getRevision() const {
+  return _revision;
+}
+
 const ConvexHull& ConvexHullImageMask::getConvexHull() const {
   return _convex_hull;
 }
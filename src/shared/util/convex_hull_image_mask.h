@@ -3,6 +3,7 @@
 
 #include "image.h"
 #include "convex_hull.h"
+#include "mask_spans.h"
 #include "VarTypes.h"
 #include <qmutex.h>
 
@@ -11,6 +12,8 @@ class ConvexHullImageMask : public QObject {
  private:
   ConvexHull _convex_hull;
   Image<raw8> _mask;
+  MaskSpans _spans;
+  int _revision;
   VarTypes::VarExternal * _v_settings;
   VarTypes::VarList * _v_list;
   mutable QMutex mutex;
@@ -28,6 +31,10 @@ class ConvexHullImageMask : public QObject {
   int getWidth() const;
   int getHeight() const;
   const Image<raw8>& getMask() const;
+  /// the part of each row of the mask that is not masked out, updated together with the mask
+  const MaskSpans& getSpans() const;
+  /// changes whenever the mask is recomputed
+  int getRevision() const;
   const ConvexHull& getConvexHull() const;
 
   void lock() const;
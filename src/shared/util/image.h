@@ -26,6 +26,8 @@
 #include <cstdio>
 #include <cassert>
 #include <string>
+#include <new>
+#include <type_traits>
 #include "colors.h"
 #include "util.h"
 #include "image_interface.h"
@@ -33,10 +35,13 @@
 #include "image_io.h"
 #include "font.h"
 #include "conversions.h"
+#include "image_buffer_pool.h"
 
 /*!
   \class Image
   \brief A template-based 2D raster-image class
+
+  The pixels of an allocated image live in a buffer of the ImageBufferPool.
 */
 template <class PIXEL>
 class Image : public ImageInterface
@@ -90,12 +95,17 @@ public:
     assert(w >= 0 && h >= 0);
     if (data!=0 && _external==false) {
       if (width==w && height==h) return;
-      delete[] data;
+      ImageBufferPool::getInstance().release((unsigned char *)data);
     }
     if (w==0 && h==0) {
       data=0;
     } else {
-      data=new PIXEL[w*h];
+      data=(PIXEL *)ImageBufferPool::getInstance().acquire(sizeof(PIXEL)*w*h);
+      //like new PIXEL[]: trivial pixels are left uninitialized, the color
+      //types of colors.h still run their (zeroing) default constructors
+      if (!std::is_trivially_default_constructible<PIXEL>::value) {
+        for (int i=0;i<w*h;i++) new (&data[i]) PIXEL;
+      }
     }
     _external=false;
     width=w;
@@ -129,7 +139,7 @@ public:
   ~Image()
   {
     if (data!=0 && _external==false) {
-      delete[] data;
+      ImageBufferPool::getInstance().release((unsigned char *)data);
     }
   }
 
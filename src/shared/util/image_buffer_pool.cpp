@@ -0,0 +1,143 @@
+//========================================================================
+//  This software is free: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License Version 3,
+//  as published by the Free Software Foundation.
+//
+//  This software is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  Version 3 in the file COPYING that came with this distribution.
+//  If not, see <http://www.gnu.org/licenses/>.
+//========================================================================
+/*!
+  \file    image_buffer_pool.cpp
+  \brief   C++ Implementation: ImageBufferPool
+*/
+//========================================================================
+
+#include "image_buffer_pool.h"
+#include <stdlib.h>
+#include <string.h>
+#include <new>
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <sys/mman.h>
+#endif
+
+static const size_t PageSize = 4096;
+static const size_t HugePageSize = 2*1024*1024;
+
+static size_t roundUp(size_t value, size_t multiple) {
+  return (value + multiple - 1) / multiple * multiple;
+}
+
+ImageBufferPool & ImageBufferPool::getInstance() {
+  //never destroyed, as images with static storage duration may release their buffers at exit
+  static ImageBufferPool * instance=new ImageBufferPool();
+  return *instance;
+}
+
+ImageBufferPool::ImageBufferPool() {
+  static_assert(sizeof(Header) <= Alignment, "the block header must fit into the alignment padding");
+  cached_bytes=0;
+  max_cached_bytes=512*1024*1024;
+  huge_pages=false;
+}
+
+ImageBufferPool::~ImageBufferPool() {
+  for (auto & entry : free_blocks) {
+    for (auto h : entry.second) freeBlock(h);
+  }
+}
+
+int ImageBufferPool::currentNode() {
+#if defined(__linux__) && defined(SYS_getcpu)
+  unsigned int cpu=0;
+  unsigned int node=0;
+  if (syscall(SYS_getcpu, &cpu, &node, nullptr) == 0) return (int)node;
+#endif
+  return 0;
+}
+
+void ImageBufferPool::setHugePages(bool enabled) {
+  huge_pages=enabled;
+}
+
+void ImageBufferPool::setMaxCachedBytes(size_t bytes) {
+  std::vector<Header *> trimmed;
+  {
+    const std::lock_guard<std::mutex> lock(mutex);
+    max_cached_bytes=bytes;
+    for (auto & entry : free_blocks) {
+      while (cached_bytes > max_cached_bytes && !entry.second.empty()) {
+        cached_bytes-=entry.second.back()->capacity;
+        trimmed.push_back(entry.second.back());
+        entry.second.pop_back();
+      }
+    }
+  }
+  for (auto h : trimmed) freeBlock(h);
+}
+
+size_t ImageBufferPool::getCachedBytes() {
+  const std::lock_guard<std::mutex> lock(mutex);
+  return cached_bytes;
+}
+
+ImageBufferPool::Header * ImageBufferPool::allocateBlock(size_t capacity, bool huge) {
+  size_t size=capacity + Alignment;
+  void * base=nullptr;
+  if (posix_memalign(&base, huge ? HugePageSize : PageSize, size) != 0) {
+    throw std::bad_alloc();
+  }
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+  if (huge) madvise(base, size, MADV_HUGEPAGE);
+#endif
+  //first touch: fault in all pages now, on the node of the calling thread
+  memset(base, 0, size);
+  Header * h=(Header *)base;
+  h->base=base;
+  h->capacity=capacity;
+  h->node=currentNode();
+  return h;
+}
+
+void ImageBufferPool::freeBlock(Header * h) {
+  free(h->base);
+}
+
+unsigned char * ImageBufferPool::acquire(size_t bytes) {
+  bool huge=huge_pages && bytes + Alignment >= HugePageSize;
+  size_t capacity=huge ? roundUp(bytes + Alignment, HugePageSize) - Alignment
+                       : roundUp(bytes + Alignment, PageSize) - Alignment;
+  Header * h=nullptr;
+  {
+    const std::lock_guard<std::mutex> lock(mutex);
+    auto it=free_blocks.find(std::make_pair(currentNode(), capacity));
+    if (it != free_blocks.end() && !it->second.empty()) {
+      h=it->second.back();
+      it->second.pop_back();
+      cached_bytes-=capacity;
+    }
+  }
+  if (h == nullptr) h=allocateBlock(capacity, huge);
+  return (unsigned char *)h + Alignment;
+}
+
+void ImageBufferPool::release(unsigned char * data) {
+  if (data == nullptr) return;
+  Header * h=(Header *)(data - Alignment);
+  {
+    const std::lock_guard<std::mutex> lock(mutex);
+    if (cached_bytes + h->capacity <= max_cached_bytes) {
+      free_blocks[std::make_pair(h->node, h->capacity)].push_back(h);
+      cached_bytes+=h->capacity;
+      return;
+    }
+  }
+  freeBlock(h);
+}
@@ -0,0 +1,92 @@
+//========================================================================
+//  This software is free: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License Version 3,
+//  as published by the Free Software Foundation.
+//
+//  This software is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  Version 3 in the file COPYING that came with this distribution.
+//  If not, see <http://www.gnu.org/licenses/>.
+//========================================================================
+/*!
+  \file    image_buffer_pool.h
+  \brief   C++ Interface: ImageBufferPool
+*/
+//========================================================================
+
+#ifndef IMAGE_BUFFER_POOL_H
+#define IMAGE_BUFFER_POOL_H
+#include <stddef.h>
+#include <mutex>
+#include <atomic>
+#include <map>
+#include <vector>
+#include <utility>
+
+/*!
+  \class   ImageBufferPool
+  \brief   A process-wide allocator which recycles the pixel buffers of images
+
+  Buffers are aligned to 64 bytes, so that SIMD code can use aligned loads.
+  Released buffers are kept per size class (a multiple of the page size)
+  and handed out again to the next request of the same class, so images
+  which are reallocated with an unchanged format do not cause heap calls.
+
+  New buffers are written once by the requesting thread. Thereby all pages
+  are faulted in right away, and the kernel places them on the NUMA node of
+  that thread (usually a pinned camera thread). Recycled buffers are only
+  handed out to threads running on the same node.
+
+  With huge pages enabled, buffers of 2 MB and more are allocated 2 MB
+  aligned and marked for transparent huge pages.
+
+  The amount of memory kept for recycling is limited, buffers released
+  beyond that limit are freed.
+*/
+class ImageBufferPool
+{
+public:
+  static const size_t Alignment = 64;
+
+  static ImageBufferPool & getInstance();
+
+  /// returns a buffer of at least \p bytes bytes
+  unsigned char * acquire(size_t bytes);
+  /// returns a buffer obtained from acquire() to the pool
+  void release(unsigned char * data);
+
+  /// use transparent huge pages for buffers of 2 MB and more
+  void setHugePages(bool enabled);
+  /// sets the amount of memory that is kept for recycling
+  void setMaxCachedBytes(size_t bytes);
+  size_t getCachedBytes();
+
+protected:
+  //stored in the first Alignment bytes of each allocation, directly before the data
+  struct Header {
+    void * base;
+    size_t capacity;
+    int node;
+  };
+
+  std::mutex mutex;
+  std::map<std::pair<int, size_t>, std::vector<Header *> > free_blocks; //(NUMA node, capacity) -> buffers
+  size_t cached_bytes;
+  size_t max_cached_bytes;
+  std::atomic<bool> huge_pages;
+
+  ImageBufferPool();
+  ~ImageBufferPool();
+  ImageBufferPool(const ImageBufferPool &);
+  ImageBufferPool & operator= (const ImageBufferPool &);
+
+  static int currentNode();
+  Header * allocateBlock(size_t capacity, bool huge);
+  static void freeBlock(Header * h);
+};
+
+#endif
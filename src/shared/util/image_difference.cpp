@@ -0,0 +1,95 @@
+//========================================================================
+//  This software is free: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License Version 3,
+//  as published by the Free Software Foundation.
+//
+//  This software is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  Version 3 in the file COPYING that came with this distribution.
+//  If not, see <http://www.gnu.org/licenses/>.
+//========================================================================
+/*!
+  \file    image_difference.cpp
+  \brief   C++ Implementation: ImageDifference
+*/
+//========================================================================
+
+#include "image_difference.h"
+#include "simd_dispatch.h"
+#ifdef SIMD_DISPATCH_X86
+#include <x86intrin.h>
+#endif
+
+typedef unsigned int (*SadKernel)(const unsigned char * a, const unsigned char * b, int n);
+
+static unsigned int sad_Scalar(const unsigned char * a, const unsigned char * b, int n) {
+  unsigned int sum=0;
+  for (int i=0;i<n;i++) {
+    sum+=(a[i] > b[i]) ? a[i] - b[i] : b[i] - a[i];
+  }
+  return sum;
+}
+
+#ifdef SIMD_DISPATCH_X86
+// psadbw sums the absolute differences of 8 bytes into each 64 bit lane
+
+SIMD_TARGET("sse4.1")
+static unsigned int sad_SSE41(const unsigned char * a, const unsigned char * b, int n) {
+  __m128i sum = _mm_setzero_si128();
+  int i=0;
+  for (; i + 16 <= n; i+=16) {
+    sum = _mm_add_epi64(sum, _mm_sad_epu8(_mm_loadu_si128((const __m128i*)(a + i)), _mm_loadu_si128((const __m128i*)(b + i))));
+  }
+  return (unsigned int)(_mm_cvtsi128_si64(sum) + _mm_extract_epi64(sum, 1)) + sad_Scalar(a + i, b + i, n - i);
+}
+
+SIMD_TARGET("avx2")
+static unsigned int sumLanes_AVX2(__m256i sum) {
+  const __m128i half = _mm_add_epi64(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+  return (unsigned int)(_mm_cvtsi128_si64(half) + _mm_extract_epi64(half, 1));
+}
+
+SIMD_TARGET("avx2")
+static unsigned int sad_AVX2(const unsigned char * a, const unsigned char * b, int n) {
+  __m256i sum = _mm256_setzero_si256();
+  int i=0;
+  for (; i + 32 <= n; i+=32) {
+    sum = _mm256_add_epi64(sum, _mm256_sad_epu8(_mm256_loadu_si256((const __m256i*)(a + i)), _mm256_loadu_si256((const __m256i*)(b + i))));
+  }
+  return sumLanes_AVX2(sum) + sad_SSE41(a + i, b + i, n - i);
+}
+
+SIMD_TARGET("avx512f,avx512bw")
+static unsigned int sad_AVX512(const unsigned char * a, const unsigned char * b, int n) {
+  __m512i sum = _mm512_setzero_si512();
+  int i=0;
+  for (; i + 64 <= n; i+=64) {
+    sum = _mm512_add_epi64(sum, _mm512_sad_epu8(_mm512_loadu_si512((const void*)(a + i)), _mm512_loadu_si512((const void*)(b + i))));
+  }
+  //fold the halves with the zero-masked extract: the unmasked form, the cast and
+  //_mm512_reduce_add_epi64 all read an undefined register under GCC 12
+  const __m256i half = _mm256_add_epi64(_mm512_maskz_extracti64x4_epi64(0xF, sum, 0), _mm512_maskz_extracti64x4_epi64(0xF, sum, 1));
+  return sumLanes_AVX2(half) + sad_AVX2(a + i, b + i, n - i);
+}
+
+static const SimdKernel<SadKernel> sad_kernel(sad_Scalar, sad_SSE41, sad_AVX2, sad_AVX512);
+#else
+static const SimdKernel<SadKernel> sad_kernel(sad_Scalar, nullptr, nullptr, nullptr);
+#endif
+
+unsigned int ImageDifference::sad(const unsigned char * a, const unsigned char * b, int n) {
+  return sad_kernel.get()(a, b, n);
+}
+
+unsigned int ImageDifference::sadBlock(const unsigned char * a, const unsigned char * b, int row_bytes, int rows, int stride) {
+  SadKernel kernel=sad_kernel.get();
+  unsigned int sum=0;
+  for (int y=0;y<rows;y++) {
+    sum+=kernel(a + y*stride, b + y*stride, row_bytes);
+  }
+  return sum;
+}
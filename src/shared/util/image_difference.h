@@ -0,0 +1,40 @@
+//========================================================================
+//  This software is free: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License Version 3,
+//  as published by the Free Software Foundation.
+//
+//  This software is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  Version 3 in the file COPYING that came with this distribution.
+//  If not, see <http://www.gnu.org/licenses/>.
+//========================================================================
+/*!
+  \file    image_difference.h
+  \brief   C++ Interface: ImageDifference
+*/
+//========================================================================
+
+#ifndef IMAGE_DIFFERENCE_H
+#define IMAGE_DIFFERENCE_H
+
+/*!
+  \class   ImageDifference
+  \brief   Measures how much parts of two images differ
+
+  The sums are computed by the SIMD kernel selected by SimdDispatch.
+*/
+class ImageDifference
+{
+public:
+  /// the sum of the absolute differences of the \p n bytes at \p a and \p b
+  static unsigned int sad(const unsigned char * a, const unsigned char * b, int n);
+  /// the sum of the absolute differences of a block of \p rows rows of \p row_bytes
+  /// bytes each. The rows of both images are \p stride bytes apart.
+  static unsigned int sadBlock(const unsigned char * a, const unsigned char * b, int row_bytes, int rows, int stride);
+};
+
+#endif
@@ -0,0 +1,117 @@
+//========================================================================
+//  This software is free: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License Version 3,
+//  as published by the Free Software Foundation.
+//
+//  This software is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  Version 3 in the file COPYING that came with this distribution.
+//  If not, see <http://www.gnu.org/licenses/>.
+//========================================================================
+/*!
+  \file    lockfree_ringbuffer.h
+  \brief   C++ Interface: LockFreeRingBuffer, TripleBuffer
+*/
+//========================================================================
+
+#ifndef LOCKFREE_RINGBUFFER_H_
+#define LOCKFREE_RINGBUFFER_H_
+#include <atomic>
+#include <stdint.h>
+#include "ringbuffer.h"
+
+/*!
+  \class LockFreeRingBuffer
+  \brief A lock-free single-producer/single-consumer variant of RingBuffer
+
+  This class provides the exact same semantics as RingBuffer, but
+  without locking a mutex on every index operation.
+
+  The read-, write- and previous-write-indices are packed into a single
+  atomic word. nextWrite() and nextRead() compute their new index from one
+  snapshot of all indices and commit it with a compare-and-swap, so the
+  reader and the writer can never end up in the same bin.
+
+  There must only be a single writer thread. Multiple readers have to
+  coordinate using lockRead() / unlockRead(), as with RingBuffer.
+  The buffer supports up to 255 bins.
+*/
+template <class ITEM>
+class LockFreeRingBuffer : public RingBuffer<ITEM> {
+  protected:
+    std::atomic<uint32_t> state;
+
+    static int readIdx ( uint32_t s ) { return s & 0xff; }
+    static int writeIdx ( uint32_t s ) { return ( s >> 8 ) & 0xff; }
+    static int prevWriteIdx ( uint32_t s ) { return ( s >> 16 ) & 0xff; }
+    static uint32_t pack ( int read, int write, int prev_write ) {
+      return ( uint32_t ) read | ( ( uint32_t ) write << 8 ) | ( ( uint32_t ) prev_write << 16 );
+    }
+
+  public:
+    /*!
+      \brief Constructor of the LockFreeRingBuffer
+      \param _size determines how many elements are stored in it.
+
+      Note that \p _size needs to be at least 2 and at most 255!
+    */
+    LockFreeRingBuffer ( int _size ) : RingBuffer<ITEM> ( _size ) {
+      state.store ( pack ( 0,1,0 ) );
+    }
+
+    int nextWrite ( bool allow_lapping ) override {
+      uint32_t s = state.load ( std::memory_order_acquire );
+      uint32_t n;
+      do {
+        int write = this->next ( writeIdx ( s ),readIdx ( s ),allow_lapping );
+        n = pack ( readIdx ( s ),write,writeIdx ( s ) );
+      } while ( !state.compare_exchange_weak ( s,n,std::memory_order_acq_rel,std::memory_order_acquire ) );
+      this->signalWrite();
+      return writeIdx ( n );
+    }
+
+    int nextRead ( bool skip_frames ) override {
+      uint32_t s = state.load ( std::memory_order_acquire );
+      uint32_t n;
+      do {
+        int read;
+        if ( skip_frames ) {
+          int prev_write = prevWriteIdx ( s );
+          int prev_frame = ( prev_write==0 ) ? this->size-1 : prev_write-1;
+          read = this->next ( prev_frame,writeIdx ( s ),true );
+        } else {
+          read = this->next ( readIdx ( s ),writeIdx ( s ),true );
+        }
+        n = pack ( read,writeIdx ( s ),prevWriteIdx ( s ) );
+      } while ( !state.compare_exchange_weak ( s,n,std::memory_order_acq_rel,std::memory_order_acquire ) );
+      return readIdx ( n );
+    }
+
+    int curWrite() override {
+      return writeIdx ( state.load ( std::memory_order_acquire ) );
+    }
+
+    int curRead() override {
+      return readIdx ( state.load ( std::memory_order_acquire ) );
+    }
+};
+
+/*!
+  \class TripleBuffer
+  \brief A lock-free latest-item buffer with three bins
+
+  One bin is owned by the writer, one by the reader, and the third one holds
+  the most recently completed item. Reading with nextRead(true) always skips
+  ahead to the most recent item, and the writer never has to wait.
+*/
+template <class ITEM>
+class TripleBuffer : public LockFreeRingBuffer<ITEM> {
+  public:
+    TripleBuffer() : LockFreeRingBuffer<ITEM> ( 3 ) {}
+};
+
+#endif /*LOCKFREE_RINGBUFFER_H_*/
@@ -24,6 +24,7 @@
 #include "colors.h"
 #include "conversions.h"
 #include <assert.h>
+#include <atomic>
 #include <vector>
 #include <string>
 #include <qmutex.h>
@@ -100,6 +101,7 @@ class LUT3D : public QObject {
     vector<LUTChannel> channels;
     vector<LUT3D *> derived_LUTs;
     QMutex mutex;
+    std::atomic<int> revision;
   protected slots:
     void slotVBlobChange() {
       updateDerivedLUTs();
@@ -126,6 +128,7 @@ class LUT3D : public QObject {
       LUT_SIZE = (0x01 << (TOTAL_BITS+1));// + 1;
       channels.resize(sizeof(lut_mask_t));
       LUT=new lut_mask_t[LUT_SIZE];
+      revision=0;
 
       if (filename=="") {
         v_settings=0;
@@ -224,6 +227,7 @@ class LUT3D : public QObject {
       return result;
     }
 
+    //called by everything that edits the table once its changes are complete
     void updateDerivedLUTs() {
       lock();
       int n = derived_LUTs.size();
@@ -231,9 +235,16 @@ class LUT3D : public QObject {
         derived_LUTs[i]->copyChannels(*this);
         derived_LUTs[i]->deriveFromLUT(this);
       }
+      revision++;
       unlock(); 
     }
 
+    /// changes with every reset() and updateDerivedLUTs(), so that results
+    /// computed from the table can tell whether they are outdated
+    int getRevision() const {
+      return revision;
+    }
+
     virtual void deriveFromLUT(LUT3D * lut) {
       for (int x=0;x<=255;x++) {
         for (int y=0;y<=255;y++) {
@@ -303,6 +314,7 @@ class LUT3D : public QObject {
     void reset() {
       lock();
       memset(LUT,0x00,LUT_SIZE*sizeof(lut_mask_t));
+      revision++;
       unlock();
     };
 
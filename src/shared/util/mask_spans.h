@@ -0,0 +1,77 @@
+//========================================================================
+//  This software is free: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License Version 3,
+//  as published by the Free Software Foundation.
+//
+//  This software is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  Version 3 in the file COPYING that came with this distribution.
+//  If not, see <http://www.gnu.org/licenses/>.
+//========================================================================
+/*!
+  \file    mask_spans.h
+  \brief   C++ Interface: MaskSpan
+*/
+//========================================================================
+
+#ifndef MASK_SPANS_H
+#define MASK_SPANS_H
+#include <vector>
+
+/*!
+  \struct  MaskSpan
+  \brief   The pixels [begin, end) of an image row that an image mask may let through
+
+  All pixels of the row outside its spans are masked out, so that
+  processing can skip them. Pixels inside a span still have to be
+  checked against the mask.
+*/
+struct MaskSpan {
+  int begin;
+  int end;
+};
+
+/// the spans of one image row, sorted, non-empty and with gaps in between.
+/// A row without spans is masked out completely.
+typedef std::vector<MaskSpan> RowSpans;
+
+/// the RowSpans of every image row
+typedef std::vector<RowSpans> MaskSpans;
+
+/// adds the pixels [\p begin, \p end) to \p row, merging them with the
+/// spans they overlap or touch
+inline void addSpan(RowSpans & row, int begin, int end) {
+  if (begin >= end) return;
+  RowSpans::iterator first=row.begin();
+  while (first != row.end() && first->end < begin) ++first;
+  RowSpans::iterator last=first;
+  while (last != row.end() && last->begin <= end) {
+    if (last->begin < begin) begin=last->begin;
+    if (last->end > end) end=last->end;
+    ++last;
+  }
+  MaskSpan span;
+  span.begin=begin;
+  span.end=end;
+  if (first == last) {
+    row.insert(first, span);
+  } else {
+    *first=span;
+    row.erase(first + 1, last);
+  }
+}
+
+/// whether pixel \p x lies within a span of \p row
+inline bool containsPixel(const RowSpans & row, int x) {
+  for (const MaskSpan & span : row) {
+    if (x < span.begin) return false;
+    if (x < span.end) return true;
+  }
+  return false;
+}
+
+#endif
@@ -21,6 +21,7 @@
 
 #include "rawimage.h"
 #include "conversions.h"
+#include "image_buffer_pool.h"
 
 RawImage::RawImage()
 {
@@ -71,6 +72,11 @@ int RawImage::getNumPixels() const
   return width*height;
 }
 
+bool RawImage::isLeased() const
+{
+  return leased;
+}
+
 int RawImage::getNumBytes() const
 {
   return computeImageSize(format,getNumPixels());
@@ -113,20 +119,34 @@ void RawImage::setTimeCam(double t)
   time_cam=t;
 }
 
+void RawImage::releaseData()
+{
+  if (!leased) {
+    if (pooled) {
+      ImageBufferPool::getInstance().release(data);
+    } else {
+      delete[] data;
+    }
+  }
+  leased=false;
+  pooled=false;
+}
+
 void RawImage::setData(unsigned char * d)
 {
-  delete[] data;
+  releaseData();
   data=d;
 }
 
 void  RawImage::allocate (ColorFormat fmt, int w, int h)
 {
   if(w >= 0 && h >= 0) {
-    delete[] data;
+    releaseData();
     if (w==0 && h==0) {
       data=nullptr;
     } else {
-      data=new unsigned char[computeImageSize(fmt,w*h)];
+      data=ImageBufferPool::getInstance().acquire(computeImageSize(fmt,w*h));
+      pooled=true;
     }
     width=w;
     height=h;
@@ -136,7 +156,7 @@ void  RawImage::allocate (ColorFormat fmt, int w, int h)
 
 void  RawImage::ensure_allocation (ColorFormat fmt, int w, int h)
 {
-  if(data == nullptr || format != fmt || width != w || height!=h) {
+  if(data == nullptr || leased || format != fmt || width != w || height!=h) {
     allocate(fmt,w,h);
   }
 }
@@ -150,6 +170,28 @@ void RawImage::deepCopyFromRawImage(const RawImage & img, bool copyMetaData)
   }
 }
 
+void RawImage::lease(const RawImage & img)
+{
+  releaseData();
+  data=img.getData();
+  leased=true;
+  width=img.getWidth();
+  height=img.getHeight();
+  format=img.getColorFormat();
+  time=img.getTime();
+  time_cam=img.getTimeCam();
+}
+
+void RawImage::detach()
+{
+  if (!leased) return;
+  const unsigned char * source=data;
+  allocate(format,width,height);
+  if (source != nullptr && data != nullptr) {
+    memcpy(data,source,getNumBytes());
+  }
+}
+
 void RawImage::clear()
 {
   allocate(getColorFormat(),0,0);
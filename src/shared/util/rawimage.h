@@ -32,6 +32,9 @@
   The RawImage class stores a pointer and basic meta-data (width,
   height, color-format, timestamp).
 
+  Buffers allocated by the image itself come from the ImageBufferPool.
+  A buffer passed to setData() is owned by the image and freed with delete[].
+
   This class is mostly used for storing captured data.
   For an image class providing higher level processing functions, look at
   Image and its template instantiations rgbImage, rgbaImage, greyImage etc.
@@ -57,6 +60,16 @@ class RawImage : public ImageInterface
   /// capture timestamp of the image in [ns]
   double time_cam = 0;
 
+  /// true if \p data references a buffer owned by someone else
+  /// (e.g. a capture driver), which must not be freed or written to
+  bool leased = false;
+
+  /// true if \p data was obtained from the ImageBufferPool
+  bool pooled = false;
+
+  /// frees \p data unless it is leased
+  void releaseData();
+
   public:
   RawImage();
 
@@ -72,6 +85,7 @@ class RawImage : public ImageInterface
   int getNumBytes() const;
   int getNumColorBlocks() const;
   int getNumPixels() const;
+  bool isLeased() const;
 
   rgb getRgb(int x, int y) const;
   yuv getYuv(int x, int y) const;
@@ -86,6 +100,10 @@ class RawImage : public ImageInterface
   void allocate (ColorFormat fmt, int w, int h);
   void ensure_allocation (ColorFormat fmt, int w, int h);
   void deepCopyFromRawImage(const RawImage & img, bool copyMetaData);
+  void lease(const RawImage & img);
+  /// replaces a leased buffer by an own copy of it, so that the image stays
+  /// valid once the lease ends. Does nothing if the image is not leased.
+  void detach();
   void clear();
 
   //helpers:
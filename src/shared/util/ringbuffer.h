@@ -22,6 +22,10 @@
 #ifndef RINGBUFFER_H_
 #define RINGBUFFER_H_
 #include <qmutex.h>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
 
 /*!
   \class RingBuffer
@@ -40,6 +44,9 @@
   The ringbuffer ensures that
     1) the reader and the writer will NEVER access the same bin at the same time
     2) the reader will not leap ahead over the writer
+
+  Readers do not need to poll for new data: waitForWrite() blocks until
+  the writer completed its next bin (i.e. called nextWrite()).
 */
 
 template <class ITEM>
@@ -47,6 +54,22 @@ class RingBuffer {
   protected:
     QMutex mutex;
     QMutex readlock;
+
+    //write notification. the writer only touches notify_mutex if somebody waits
+    std::atomic<unsigned long> write_count;
+    std::atomic<int> waiters;
+    std::mutex notify_mutex;
+    std::condition_variable notify_cv;
+
+    void signalWrite() {
+      write_count.fetch_add ( 1 );
+      if ( waiters.load() > 0 ) {
+        {
+          const std::lock_guard<std::mutex> lock ( notify_mutex );
+        }
+        notify_cv.notify_all();
+      }
+    }
   public:
     ITEM * items;
   private:
@@ -70,13 +93,15 @@ class RingBuffer {
       previous_write=0;
       current_write=1;
       size=_size;
+      write_count.store ( 0 );
+      waiters.store ( 0 );
 
     }
     virtual ~RingBuffer() {
       delete[] items;
     }
-  private:
-    int next ( int cur_idx, int not_avail, bool preventLap ) {
+  protected:
+    int next ( int cur_idx, int not_avail, bool preventLap ) const {
       //if preventLap is true then we won't jump over
       //not_avail.
       int idx=cur_idx+1;
@@ -125,12 +150,13 @@ class RingBuffer {
 
       nextWrite is thread-safe and atomic.
     */
-    int nextWrite ( bool allow_lapping ) {
+    virtual int nextWrite ( bool allow_lapping ) {
       mutex.lock();
       previous_write=current_write;
       current_write=next ( current_write,current_read, allow_lapping );
       int res=current_write;
       mutex.unlock();
+      signalWrite();
       return res;
     }
 
@@ -150,7 +176,7 @@ class RingBuffer {
 
       nextRead is thread-safe and atomic.
     */
-    int nextRead ( bool skip_frames ) {
+    virtual int nextRead ( bool skip_frames ) {
       mutex.lock();
       previous_read=current_read;
       if ( skip_frames ) {
@@ -173,7 +199,7 @@ class RingBuffer {
     /*!
       \brief returns the index of the current write-bin
     */
-    int curWrite() {
+    virtual int curWrite() {
       int res;
       mutex.lock();
       res=current_write;
@@ -184,7 +210,7 @@ class RingBuffer {
     /*!
       \brief returns the index of the current read-bin
     */
-    int curRead() {
+    virtual int curRead() {
       int res;
       mutex.lock();
       res=current_read;
@@ -192,6 +218,37 @@ class RingBuffer {
       return res;
     }
 
+    /*!
+      \brief returns the number of completed writes so far
+    */
+    unsigned long getWriteCount() const {
+      return write_count.load();
+    }
+
+    /*!
+      \brief waits until a write was completed after \p last_seen
+
+      \p last_seen is a value of getWriteCount() and is updated to the current
+      count on return. Returns true if new data was written, false if
+      \p timeout_ms expired before that.
+    */
+    bool waitForWrite ( unsigned long & last_seen, int timeout_ms ) {
+      unsigned long cur = write_count.load();
+      if ( cur == last_seen ) {
+        waiters.fetch_add ( 1 );
+        std::unique_lock<std::mutex> lock ( notify_mutex );
+        notify_cv.wait_for ( lock, std::chrono::milliseconds ( timeout_ms ), [&] {
+          cur = write_count.load();
+          return cur != last_seen;
+        } );
+        lock.unlock();
+        waiters.fetch_sub ( 1 );
+      }
+      bool res = ( cur != last_seen );
+      last_seen = cur;
+      return res;
+    }
+
     /*!
       \brief locks the readlock mutex
       This function is only required for scenarios where you expect to have
@@ -0,0 +1,134 @@
+//========================================================================
+//  This software is free: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License Version 3,
+//  as published by the Free Software Foundation.
+//
+//  This software is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  Version 3 in the file COPYING that came with this distribution.
+//  If not, see <http://www.gnu.org/licenses/>.
+//========================================================================
+/*!
+  \file    settings_snapshot.h
+  \brief   C++ Interface: SettingsSnapshot
+*/
+//========================================================================
+
+#ifndef SETTINGS_SNAPSHOT_H
+#define SETTINGS_SNAPSHOT_H
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <functional>
+#include "VarNotifier.h"
+
+using namespace VarTypes;
+
+/*!
+  \class   SettingsSnapshot
+  \brief   An immutable copy of a plugin's settings which can be read without locking
+
+  The owner describes once how the struct \p T is filled from its VarTypes
+  and calls watch() with the root of its settings. Whenever a watched VarType
+  changes, a new struct is built on the thread that owns the VarNotifier
+  (the GUI thread) and published by swapping an atomic pointer.
+
+  The processing threads read the plain fields through get():
+
+    SettingsSnapshot<Settings>::Reader s=snapshot.get();
+    if (s->enable) ...
+
+  A Reader keeps its snapshot alive until it is destroyed, so it should only
+  live for the duration of one process() call. Replaced snapshots are freed
+  by a later change once no Reader is active.
+*/
+template <class T>
+class SettingsSnapshot
+{
+public:
+  typedef std::function<void(T &)> ReadFunction;
+
+  class Reader
+  {
+    friend class SettingsSnapshot;
+  protected:
+    const SettingsSnapshot * owner;
+    const T * data;
+    explicit Reader(const SettingsSnapshot & s) : owner(&s) {
+      owner->readers++;
+      data=owner->current.load();
+    }
+    Reader(const Reader &);
+    Reader & operator= (const Reader &);
+  public:
+    Reader(Reader && other) : owner(other.owner), data(other.data) {
+      other.owner=nullptr;
+    }
+    ~Reader() {
+      if (owner != nullptr) owner->readers--;
+    }
+    const T * operator->() const { return data; }
+    const T & operator*() const { return *data; }
+  };
+
+protected:
+  ReadFunction read;
+  std::atomic<const T *> current;
+  mutable std::atomic<int> readers;
+  std::mutex write_mutex;
+  std::vector<const T *> retired;
+  VarNotifier notifier;
+
+  SettingsSnapshot(const SettingsSnapshot &);
+  SettingsSnapshot & operator= (const SettingsSnapshot &);
+
+public:
+  explicit SettingsSnapshot(ReadFunction _read) : read(_read), current(new T()), readers(0) {
+    QObject::connect(&notifier, &VarNotifier::changeOccured, &notifier, [this](VarType *) { refresh(); });
+  }
+
+  ~SettingsSnapshot() {
+    notifier.disconnect();
+    delete current.load();
+    for (auto s : retired) delete s;
+  }
+
+  /// publishes the current values and follows all changes of \p settings and its children.
+  /// Statistics (read-only and not stored) are published by the owner itself and are not followed,
+  /// so that updating them does not rebuild the snapshot.
+  void watch(VarType * settings) {
+    std::vector<VarType *> queue(1, settings);
+    while (!queue.empty()) {
+      VarType * v=queue.back();
+      queue.pop_back();
+      if (v == 0 || v->areFlagsSet(VARTYPE_FLAG_READONLY | VARTYPE_FLAG_NOSTORE)) continue;
+      notifier.addItem(v);
+      for (VarType * child : v->getChildren()) queue.push_back(child);
+    }
+    refresh();
+  }
+
+  /// rebuilds the snapshot from the VarTypes
+  void refresh() {
+    T * next=new T();
+    read(*next);
+    const std::lock_guard<std::mutex> lock(write_mutex);
+    retired.push_back(current.exchange(next));
+    //a Reader which starts after the exchange can only see the new snapshot,
+    //so without active Readers none of the retired ones is referenced anymore
+    if (readers.load() == 0) {
+      for (auto s : retired) delete s;
+      retired.clear();
+    }
+  }
+
+  Reader get() const {
+    return Reader(*this);
+  }
+};
+
+#endif
@@ -0,0 +1,65 @@
+//========================================================================
+//  This software is free: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License Version 3,
+//  as published by the Free Software Foundation.
+//
+//  This software is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  Version 3 in the file COPYING that came with this distribution.
+//  If not, see <http://www.gnu.org/licenses/>.
+//========================================================================
+/*!
+  \file    simd_dispatch.cpp
+  \brief   C++ Implementation: SimdDispatch
+*/
+//========================================================================
+
+#include "simd_dispatch.h"
+
+std::atomic<int> SimdDispatch::active(-1);
+std::atomic<int> SimdDispatch::max_level(SimdLevelCount);
+
+static const char * const LevelNames[] = { "scalar", "sse4.1", "avx2", "avx512" };
+
+int SimdDispatch::detectSupportedLevel() {
+#ifdef SIMD_DISPATCH_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")) return SimdAVX512;
+  if (__builtin_cpu_supports("avx2")) return SimdAVX2;
+  if (__builtin_cpu_supports("sse4.1")) return SimdSSE41;
+#endif
+  return SimdScalar;
+}
+
+SimdLevel SimdDispatch::getSupportedLevel() {
+  static const int supported=detectSupportedLevel();
+  return (SimdLevel)supported;
+}
+
+SimdLevel SimdDispatch::update() {
+  int level=getSupportedLevel();
+  if (max_level < level) level=max_level;
+  active=level;
+  return (SimdLevel)level;
+}
+
+void SimdDispatch::setMaxLevel(SimdLevel level) {
+  max_level=level;
+  update();
+}
+
+const char * SimdDispatch::getLevelName(SimdLevel level) {
+  if (level < SimdScalar || level >= SimdLevelCount) return "auto";
+  return LevelNames[level];
+}
+
+SimdLevel SimdDispatch::parseLevelName(const std::string & name) {
+  for (int i=0;i<SimdLevelCount;i++) {
+    if (name == LevelNames[i]) return (SimdLevel)i;
+  }
+  return SimdLevelCount;
+}
@@ -0,0 +1,96 @@
+//========================================================================
+//  This software is free: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License Version 3,
+//  as published by the Free Software Foundation.
+//
+//  This software is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  Version 3 in the file COPYING that came with this distribution.
+//  If not, see <http://www.gnu.org/licenses/>.
+//========================================================================
+/*!
+  \file    simd_dispatch.h
+  \brief   C++ Interface: SimdDispatch, SimdKernel
+*/
+//========================================================================
+
+#ifndef SIMD_DISPATCH_H
+#define SIMD_DISPATCH_H
+#include <atomic>
+#include <string>
+
+// SIMD variants are compiled with function target attributes, so that one
+// binary contains all of them regardless of the -march it is built with.
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define SIMD_DISPATCH_X86 1
+#define SIMD_TARGET(isa) __attribute__((target(isa)))
+#endif
+
+enum SimdLevel {
+  SimdScalar = 0,
+  SimdSSE41 = 1,
+  SimdAVX2 = 2,
+  SimdAVX512 = 3, //AVX-512 F and BW
+  SimdLevelCount = 4
+};
+
+/*!
+  \class   SimdDispatch
+  \brief   Determines which SIMD variant of the kernels is used
+
+  The supported instruction sets are read via CPUID on first use. The
+  active level is the supported one, unless it was limited by
+  setMaxLevel(), e.g. to compare kernels on the same machine.
+*/
+class SimdDispatch
+{
+protected:
+  static std::atomic<int> active; //-1 until determined
+  static std::atomic<int> max_level;
+  static int detectSupportedLevel();
+public:
+  static SimdLevel getSupportedLevel();
+  static SimdLevel getActiveLevel() {
+    int level=active.load(std::memory_order_relaxed);
+    return level >= 0 ? (SimdLevel)level : update();
+  }
+  /// uses kernels up to \p level only (if supported). SimdLevelCount selects the best one.
+  static void setMaxLevel(SimdLevel level);
+  static SimdLevel update();
+
+  static const char * getLevelName(SimdLevel level);
+  /// returns SimdLevelCount for "auto" or an unknown name
+  static SimdLevel parseLevelName(const std::string & name);
+};
+
+/*!
+  \class   SimdKernel
+  \brief   The variants of one kernel, one per SimdLevel
+
+  Variants may be null, the next lower level is used instead.
+  The scalar variant must always be given.
+*/
+template <class Fn>
+class SimdKernel
+{
+protected:
+  Fn variants[SimdLevelCount];
+public:
+  SimdKernel(Fn scalar, Fn sse41, Fn avx2, Fn avx512) {
+    variants[SimdScalar]=scalar;
+    variants[SimdSSE41]=sse41;
+    variants[SimdAVX2]=avx2;
+    variants[SimdAVX512]=avx512;
+  }
+  Fn get() const {
+    int level=SimdDispatch::getActiveLevel();
+    while (variants[level] == nullptr) level--;
+    return variants[level];
+  }
+};
+
+#endif
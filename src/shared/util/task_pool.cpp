@@ -0,0 +1,236 @@
+//========================================================================
+//  This software is free: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License Version 3,
+//  as published by the Free Software Foundation.
+//
+//  This software is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  Version 3 in the file COPYING that came with this distribution.
+//  If not, see <http://www.gnu.org/licenses/>.
+//========================================================================
+/*!
+  \file    task_pool.cpp
+  \brief   C++ Implementation: TaskPool, TaskGroup
+*/
+//========================================================================
+
+#include "task_pool.h"
+#include <chrono>
+#include <algorithm>
+#include "affinity_manager.h"
+
+thread_local int TaskPool::worker_index = -1;
+
+//how long an idle worker keeps looking for tasks before it goes to sleep
+static const std::chrono::microseconds IdleSpinTime(50);
+
+TaskPool & TaskPool::getInstance() {
+  //the joining thread always takes part in the work, so it does not need a worker of its own
+  static TaskPool instance(std::max(1, (int)std::thread::hardware_concurrency() - 1));
+  return instance;
+}
+
+TaskPool::TaskPool(int num_workers) {
+  queued=0;
+  sleeping=0;
+  next_queue=0;
+  running=true;
+  for (int i=0;i<num_workers;i++) {
+    queues.push_back(new Queue());
+  }
+  //workers are placed like the thread that created the pool (see AffinityManager)
+  AffinityManager::Placement placement=AffinityManager::getPlacement();
+  for (int i=0;i<num_workers;i++) {
+    workers.emplace_back([this, i, placement]() {
+      placement.demandAuxiliaryCores();
+      runWorker(i);
+    });
+  }
+}
+
+TaskPool::~TaskPool() {
+  {
+    const std::lock_guard<std::mutex> lock(sleep_mutex);
+    running=false;
+  }
+  wakeup.notify_all();
+  for (auto & t : workers) {
+    if (t.joinable()) t.join();
+  }
+  for (auto q : queues) {
+    delete q;
+  }
+}
+
+int TaskPool::getNumWorkers() const {
+  return (int)workers.size();
+}
+
+void TaskPool::push(Item item) {
+  int idx = worker_index >= 0 ? worker_index : (int)(next_queue++ % queues.size());
+  {
+    const std::lock_guard<std::mutex> lock(queues[idx]->mutex);
+    queues[idx]->items.push_back(std::move(item));
+  }
+  queued++;
+  if (sleeping.load() > 0) {
+    {
+      const std::lock_guard<std::mutex> lock(sleep_mutex);
+    }
+    wakeup.notify_one();
+  }
+}
+
+bool TaskPool::runOne(TaskGroup * only) {
+  if (queued.load() <= 0) return false;
+  int n=queues.size();
+  int home = worker_index >= 0 ? worker_index : 0;
+  Item item;
+  bool found=false;
+  for (int k=0;k<n && !found;k++) {
+    int idx=(home+k) % n;
+    Queue * q=queues[idx];
+    const std::lock_guard<std::mutex> lock(q->mutex);
+    if (q->items.empty()) continue;
+    if (only != nullptr) {
+      for (auto it=q->items.begin();it!=q->items.end();++it) {
+        if (it->group==only) {
+          item=std::move(*it);
+          q->items.erase(it);
+          found=true;
+          break;
+        }
+      }
+      continue;
+    }
+    //a worker continues with its own newest task, everybody else steals the oldest one
+    if (idx==worker_index) {
+      item=std::move(q->items.back());
+      q->items.pop_back();
+    } else {
+      item=std::move(q->items.front());
+      q->items.pop_front();
+    }
+    found=true;
+  }
+  if (!found) return false;
+  queued--;
+  item.group->unclaimed--;
+  //the group is finished even if the task throws, so that its wait() does not hang
+  struct Finish {
+    TaskGroup * group;
+    std::exception_ptr error;
+    ~Finish() { group->finish(error); }
+  } finish{item.group, nullptr};
+  try {
+    item.fn();
+  } catch (...) {
+    finish.error=std::current_exception();
+  }
+  return true;
+}
+
+void TaskPool::runWorker(int index) {
+  worker_index=index;
+  while (running) {
+    if (runOne(nullptr)) continue;
+
+    auto spin_end=std::chrono::steady_clock::now() + IdleSpinTime;
+    bool found=false;
+    while (!found && std::chrono::steady_clock::now() < spin_end) {
+      found=runOne(nullptr);
+    }
+    if (found) continue;
+
+    std::unique_lock<std::mutex> lock(sleep_mutex);
+    sleeping++;
+    wakeup.wait(lock, [&] { return !running || queued.load() > 0; });
+    sleeping--;
+  }
+}
+
+void TaskPool::parallelFor(int begin, int end, int chunks, const std::function<void(int, int)> & fn) {
+  int n=end-begin;
+  if (chunks > n) chunks=n;
+  if (chunks <= 1) {
+    if (n > 0) fn(begin, end);
+    return;
+  }
+  TaskGroup group(*this);
+  for (int i=0;i<chunks-1;i++) {
+    int first=begin + (int)((long long)n*i/chunks);
+    int last=begin + (int)((long long)n*(i+1)/chunks);
+    group.run([&fn, first, last]() { fn(first, last); });
+  }
+  fn(begin + (int)((long long)n*(chunks-1)/chunks), end);
+  group.wait();
+}
+
+void TaskPool::claimRanges(int workers, int count, int step, const std::function<void(int, int, int)> & fn) {
+  if (workers <= 1) {
+    fn(0, 0, count);
+    return;
+  }
+  std::atomic<int> next(0);
+  parallelFor(0, workers, workers, [&](int worker, int) {
+    for (int first=next.fetch_add(step); first < count; first=next.fetch_add(step)) {
+      fn(worker, first, std::min(first + step, count));
+    }
+  });
+}
+
+TaskGroup::TaskGroup(TaskPool & _pool) : pool(_pool) {
+  pending=0;
+  unclaimed=0;
+}
+
+TaskGroup::~TaskGroup() {
+  join();
+}
+
+void TaskGroup::run(TaskPool::Task fn) {
+  pending++;
+  unclaimed++;
+  TaskPool::Item item;
+  item.fn=std::move(fn);
+  item.group=this;
+  pool.push(std::move(item));
+  //a waiting thread may help with the new task
+  {
+    const std::lock_guard<std::mutex> lock(mutex);
+  }
+  changed.notify_all();
+}
+
+void TaskGroup::finish(std::exception_ptr e) {
+  const std::lock_guard<std::mutex> lock(mutex);
+  if (e && !error) error=e;
+  if (--pending == 0) changed.notify_all();
+}
+
+void TaskGroup::join() {
+  while (pending.load() > 0) {
+    //help with the tasks of this group instead of blocking the calling thread.
+    //tasks of other groups are left alone, as they could hold up the caller for long
+    if (pool.runOne(this)) continue;
+    //the remaining tasks run on other threads
+    std::unique_lock<std::mutex> lock(mutex);
+    changed.wait(lock, [&] { return pending.load() == 0 || unclaimed.load() > 0; });
+  }
+  //the last finish() may still hold the mutex, the group must outlive it
+  const std::lock_guard<std::mutex> lock(mutex);
+}
+
+void TaskGroup::wait() {
+  join();
+  std::exception_ptr e;
+  {
+    const std::lock_guard<std::mutex> lock(mutex);
+    std::swap(e, error);
+  }
+  if (e) std::rethrow_exception(e);
+}
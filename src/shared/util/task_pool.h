@@ -0,0 +1,144 @@
+//========================================================================
+//  This software is free: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License Version 3,
+//  as published by the Free Software Foundation.
+//
+//  This software is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  Version 3 in the file COPYING that came with this distribution.
+//  If not, see <http://www.gnu.org/licenses/>.
+//========================================================================
+/*!
+  \file    task_pool.h
+  \brief   C++ Interface: TaskPool, TaskGroup
+*/
+//========================================================================
+
+#ifndef TASK_POOL_H
+#define TASK_POOL_H
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <deque>
+#include <vector>
+#include <exception>
+
+class TaskGroup;
+
+/*!
+  \class   TaskPool
+  \brief   A process-wide work-stealing thread pool for intra-frame parallelism
+
+  There is a single instance, sized to the number of hardware threads,
+  which is shared by the vision stacks of all cameras.
+
+  Every worker owns a task queue. Tasks forked from a worker go to its own
+  queue, tasks forked from any other thread are distributed round-robin.
+  Workers take their own newest task first and steal the oldest tasks of
+  other queues when they run dry, so the cores of idle cameras help out
+  busy ones. Idle workers spin briefly before they go to sleep.
+
+  Tasks are forked and joined using a TaskGroup. Joining threads execute
+  the queued tasks of their group while they wait, so joining from within
+  a task is safe.
+*/
+class TaskPool
+{
+  friend class TaskGroup;
+public:
+  typedef std::function<void()> Task;
+
+  static TaskPool & getInstance();
+
+  int getNumWorkers() const;
+
+  /*!
+    \brief calls \p fn(first, last) for \p chunks consecutive ranges of [\p begin, \p end)
+
+    The ranges are processed in parallel. The last one is executed by the
+    calling thread. Returns when all ranges are done.
+  */
+  void parallelFor(int begin, int end, int chunks, const std::function<void(int, int)> & fn);
+
+  /*!
+    \brief calls \p fn(worker, first, last) for ranges of \p step items of [0, \p count)
+
+    \p workers workers, numbered from 0, claim the ranges in ascending order
+    until all items are done, which evens out ranges of different cost. The
+    calling thread is one of them. With a single worker, \p fn is called
+    once for all items.
+  */
+  void claimRanges(int workers, int count, int step, const std::function<void(int, int, int)> & fn);
+
+protected:
+  struct Item {
+    Task fn;
+    TaskGroup * group;
+  };
+  struct Queue {
+    std::mutex mutex;
+    std::deque<Item> items;
+  };
+
+  std::vector<Queue *> queues;
+  std::vector<std::thread> workers;
+  std::atomic<int> queued;
+  std::atomic<int> sleeping;
+  std::atomic<unsigned int> next_queue;
+  std::atomic<bool> running;
+  std::mutex sleep_mutex;
+  std::condition_variable wakeup;
+
+  static thread_local int worker_index; //-1 on threads which are not part of the pool
+
+  TaskPool(int num_workers);
+  ~TaskPool();
+  TaskPool(const TaskPool &);
+  TaskPool & operator= (const TaskPool &);
+
+  void push(Item item);
+  /// runs one queued task, only one of group \p only if it is not null
+  bool runOne(TaskGroup * only);
+  void runWorker(int index);
+};
+
+/*!
+  \class   TaskGroup
+  \brief   Fork/join handle for tasks on the TaskPool
+
+  run() forks a task, wait() returns once all forked tasks are done.
+  While the remaining tasks of the group run on other threads, wait()
+  sleeps until the last one finishes. If a task throws, wait() rethrows
+  the first exception once all tasks are done.
+  The destructor waits as well, but drops exceptions.
+*/
+class TaskGroup
+{
+  friend class TaskPool;
+protected:
+  TaskPool & pool;
+  std::atomic<int> pending;
+  std::atomic<int> unclaimed; //forked tasks no thread has taken yet
+  std::mutex mutex;
+  std::condition_variable changed;
+  std::exception_ptr error;
+
+  /// called by the thread which ran a task of this group, also if it threw \p e
+  void finish(std::exception_ptr e);
+  void join();
+
+public:
+  explicit TaskGroup(TaskPool & _pool = TaskPool::getInstance());
+  ~TaskGroup();
+
+  void run(TaskPool::Task fn);
+  void wait();
+};
+
+#endif
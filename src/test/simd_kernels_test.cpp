@@ -0,0 +1,274 @@
+//========================================================================
+//  This software is free: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License Version 3,
+//  as published by the Free Software Foundation.
+//
+//  This software is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  Version 3 in the file COPYING that came with this distribution.
+//  If not, see <http://www.gnu.org/licenses/>.
+//========================================================================
+/*!
+  \file    simd_kernels_test.cpp
+  \brief   Checks the SIMD kernel variants against the scalar ones
+
+  Every kernel is run once per SimdLevel the CPU supports, via
+  SimdDispatch::setMaxLevel(), and its output is compared to the one of
+  the scalar variant. Returns non-zero if any variant differs.
+*/
+//========================================================================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <algorithm>
+#include <vector>
+#include "simd_dispatch.h"
+#include "cmvision_threshold.h"
+#include "cmvision_region.h"
+#include "conversions.h"
+#include "image_difference.h"
+
+typedef std::vector<unsigned char> Bytes;
+
+static int failures=0;
+static int checks=0;
+
+static void fillRandom(unsigned char * data, int n) {
+  for (int i=0;i<n;i++) data[i]=(unsigned char)(rand() & 0xFF);
+}
+
+/// runs \p kernel, which returns its output as bytes, at every supported level
+/// above scalar and compares the output to the one of the scalar run
+template <class Kernel>
+static void compareLevels(const std::string & name, Kernel kernel) {
+  SimdDispatch::setMaxLevel(SimdScalar);
+  Bytes expected=kernel();
+  for (int level=SimdSSE41;level<=SimdDispatch::getSupportedLevel();level++) {
+    SimdDispatch::setMaxLevel((SimdLevel)level);
+    Bytes result=kernel();
+    checks++;
+    if (result != expected) {
+      size_t i=0;
+      while (i < result.size() && i < expected.size() && result[i] == expected[i]) i++;
+      fprintf(stderr,"FAIL %s: %s differs from scalar at byte %d of %d\n", name.c_str(),
+              SimdDispatch::getLevelName((SimdLevel)level), (int)i, (int)expected.size());
+      failures++;
+    }
+  }
+  SimdDispatch::setMaxLevel(SimdLevelCount);
+}
+
+static Bytes bytesOf(const Image<raw8> & img) {
+  const unsigned char * data=(const unsigned char *)img.getData();
+  return Bytes(data, data + img.getNumBytes());
+}
+
+static std::string describe(const char * kernel, int w, int h, int x_bits, int y_bits, int z_bits, bool masked) {
+  char buf[128];
+  snprintf(buf, sizeof(buf), "%s %dx%d lut %d/%d/%d %s", kernel, w, h, x_bits, y_bits, z_bits,
+           masked ? "masked" : "unmasked");
+  return buf;
+}
+
+/// up to three random spans per row with odd and even bounds, some rows
+/// without spans or covered completely
+static MaskSpans randomSpans(int w, int h) {
+  MaskSpans spans(h);
+  for (int y=0;y<h;y++) {
+    if (rand() % 5 == 0) {
+      addSpan(spans[y], 0, w);
+      continue;
+    }
+    int n=rand() % 4;
+    for (int i=0;i<n;i++) {
+      int a=rand() % (w + 1);
+      int b=rand() % (w + 1);
+      addSpan(spans[y], std::min(a, b), std::max(a, b));
+    }
+  }
+  return spans;
+}
+
+static void testThreshold(int x_bits, int y_bits, int z_bits, int w, int h, bool masked) {
+  YUVLUT lut(x_bits, y_bits, z_bits, "");
+  fillRandom(lut.getTable(), lut.LUT_SIZE);
+  RGBLUT * rgblut=new RGBLUT(x_bits, y_bits, z_bits, "");
+  fillRandom(rgblut->getTable(), rgblut->LUT_SIZE);
+  lut.addDerivedLUT(rgblut);
+
+  Image<raw8> mask;
+  mask.allocate(w, h);
+  unsigned char * mask_data=(unsigned char *)mask.getData();
+  for (int i=0;i<w*h;i++) mask_data[i]=(!masked || rand() % 4 != 0) ? 0xFF : 0x00;
+  MaskSpans spans=randomSpans(w, h);
+  const MaskSpans * row_spans=masked ? &spans : nullptr;
+
+  const ColorFormat formats[]={COLOR_YUV422_UYVY, COLOR_YUV444, COLOR_RGB8, COLOR_RAW8};
+  for (ColorFormat format : formats) {
+    //UYVY pairs pixels, its width has to be even
+    if (format == COLOR_YUV422_UYVY && (w % 2) != 0) continue;
+    RawImage source;
+    source.allocate(format, w, h);
+    fillRandom(source.getData(), source.getNumBytes());
+    std::string name=Colors::colorFormatToString(format);
+
+    if (format != COLOR_RAW8) {
+      compareLevels(describe((name + " image").c_str(), w, h, x_bits, y_bits, z_bits, masked), [&]() {
+        Image<raw8> target;
+        target.allocate(w, h);
+        if (format == COLOR_YUV422_UYVY) {
+          CMVisionThreshold::thresholdImageYUV422_UYVY(&target, &source, &lut, &mask);
+        } else if (format == COLOR_YUV444) {
+          CMVisionThreshold::thresholdImageYUV444(&target, &source, &lut, &mask);
+        } else {
+          CMVisionThreshold::thresholdImageRGB(&target, &source, rgblut, &mask);
+        }
+        return bytesOf(target);
+      });
+    }
+
+    //two row ranges, so that the second one starts within the image
+    compareLevels(describe((name + " rows").c_str(), w, h, x_bits, y_bits, z_bits, masked), [&]() {
+      Image<raw8> target;
+      target.allocate(w, h);
+      int split=h / 3;
+      CMVisionThreshold::thresholdRows(target.getPixelData(), &source, &lut, &mask, 0, split, row_spans);
+      CMVisionThreshold::thresholdRows(target.getPixelData() + split*w, &source, &lut, &mask, split, h, row_spans);
+      return bytesOf(target);
+    });
+
+    compareLevels(describe((name + " rect").c_str(), w, h, x_bits, y_bits, z_bits, masked), [&]() {
+      Image<raw8> target;
+      target.allocate(w, h);
+      memset(target.getData(), 0x55, target.getNumBytes());
+      int x0=(w / 4) & ~1;
+      CMVisionThreshold::thresholdRect(target.getPixelData(), &source, &lut, &mask, x0, h / 4, w - w / 5, h);
+      return bytesOf(target);
+    });
+  }
+}
+
+/// a thresholded image of runs of random length and class
+static void fillRuns(Image<raw8> & tmap) {
+  unsigned char * data=(unsigned char *)tmap.getData();
+  int n=tmap.getNumPixels();
+  const unsigned char classes[]={0x00, 0x01, 0x02, 0x04, 0x81};
+  for (int i=0;i<n;) {
+    int length=1 + rand() % (rand() % 4 == 0 ? 150 : 8);
+    unsigned char c=classes[rand() % 5];
+    for (int j=0;j<length && i<n;j++) data[i++]=c;
+  }
+}
+
+static Bytes bytesOf(CMVision::RunList & runs) {
+  Bytes result;
+  CMVision::Run * run=runs.getRunArrayPointer();
+  for (int i=0;i<runs.getUsedRuns();i++) {
+    int fields[]={run[i].x, run[i].y, run[i].width, run[i].color.v};
+    result.insert(result.end(), (unsigned char *)fields, (unsigned char *)(fields + 4));
+  }
+  return result;
+}
+
+static void testEncodeRuns(int w, int h, bool masked, int max_runs) {
+  Image<raw8> tmap;
+  tmap.allocate(w, h);
+  fillRuns(tmap);
+  MaskSpans spans=randomSpans(w, h);
+  char name[64];
+  snprintf(name, sizeof(name), "encodeRuns %dx%d max %d runs %s", w, h, max_runs, masked ? "masked" : "unmasked");
+  compareLevels(name, [&]() {
+    CMVision::RunList runs(max_runs);
+    CMVision::RegionProcessing::encodeRuns(&tmap, &runs, masked ? &spans : nullptr);
+    return bytesOf(runs);
+  });
+}
+
+static void testUYVY2RGB(int w, int h) {
+  Bytes source(w*h*2);
+  fillRandom(source.data(), source.size());
+  char name[64];
+  snprintf(name, sizeof(name), "uyvy2rgb %dx%d", w, h);
+  compareLevels(name, [&]() {
+    Bytes target(w*h*3);
+    Conversions::uyvy2rgb(source.data(), target.data(), w, h);
+    return target;
+  });
+}
+
+static void testSad(int n, int offset) {
+  Bytes a(n + offset), b(n + offset);
+  fillRandom(a.data(), a.size());
+  fillRandom(b.data(), b.size());
+  char name[64];
+  snprintf(name, sizeof(name), "sad %d bytes at offset %d", n, offset);
+  compareLevels(name, [&]() {
+    unsigned int sum=ImageDifference::sad(a.data() + offset, b.data() + offset, n);
+    return Bytes((unsigned char *)&sum, (unsigned char *)(&sum + 1));
+  });
+}
+
+static void testSadBlock(int row_bytes, int rows, int stride) {
+  Bytes a(rows*stride), b(rows*stride);
+  fillRandom(a.data(), a.size());
+  fillRandom(b.data(), b.size());
+  char name[64];
+  snprintf(name, sizeof(name), "sadBlock %dx%d stride %d", row_bytes, rows, stride);
+  compareLevels(name, [&]() {
+    unsigned int sum=ImageDifference::sadBlock(a.data(), b.data(), row_bytes, rows, stride);
+    return Bytes((unsigned char *)&sum, (unsigned char *)(&sum + 1));
+  });
+}
+
+int main(int argc, char ** argv) {
+  (void)argc;
+  (void)argv;
+  srand(1);
+  printf("supported SIMD level: %s\n", SimdDispatch::getLevelName(SimdDispatch::getSupportedLevel()));
+
+  //every bit depth per channel, and the mixed ones of the stacks
+  const int lut_bits[][3]={{1,1,1}, {2,2,2}, {3,3,3}, {4,4,4}, {5,5,5}, {6,6,6}, {7,7,7}, {8,8,8},
+                           {4,6,6}, {8,4,4}, {3,8,5}};
+  const int sizes[][2]={{64,48}, {66,37}, {67,9}, {2,1}, {1,3}, {130,5}};
+  for (const int * bits : lut_bits) {
+    for (const int * size : sizes) {
+      testThreshold(bits[0], bits[1], bits[2], size[0], size[1], false);
+      testThreshold(bits[0], bits[1], bits[2], size[0], size[1], true);
+    }
+  }
+
+  for (const int * size : sizes) {
+    testEncodeRuns(size[0], size[1], false, 100000);
+    testEncodeRuns(size[0], size[1], true, 100000);
+    testEncodeRuns(size[0], size[1], false, 17);
+    testEncodeRuns(size[0], size[1], true, 17);
+  }
+  testEncodeRuns(1923, 31, false, 100000);
+  testEncodeRuns(1923, 31, true, 100000);
+
+  const int uyvy_sizes[][2]={{2,1}, {30,3}, {64,48}, {66,37}, {130,5}, {1922,3}};
+  for (const int * size : uyvy_sizes) testUYVY2RGB(size[0], size[1]);
+
+  for (int n=0;n<300;n+=7) {
+    testSad(n, 0);
+    testSad(n, 3);
+  }
+  testSad(1920*2*16, 1);
+  testSadBlock(32, 16, 1920*2);
+  testSadBlock(31, 16, 67);
+  testSadBlock(97, 5, 101);
+  testSadBlock(1, 1, 1);
+
+  if (failures > 0) {
+    printf("%d of %d comparisons failed\n", failures, checks);
+    return 1;
+  }
+  printf("all %d comparisons passed\n", checks);
+  return 0;
+}